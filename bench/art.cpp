@@ -0,0 +1,121 @@
+// Ordered map operations on URL-like keys (long shared prefixes): art_map vs std::map vs a sorted std::vector,
+// all keyed by string_or_view views into the same strings and looked up by std::string_view
+//
+// Usage: string_or_view_bench_art [key count = 1000000]
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_art.h"
+#include "bench_util.h"
+
+struct view_less {
+    using is_transparent = void;
+    bool operator()(std::string_view l, std::string_view r) const noexcept { return l < r; }
+};
+
+using std_map = std::map<string_or_view, int, view_less>;
+using sorted_vector = std::vector<std::pair<string_or_view, int>>;
+
+std::vector<std::string> make_keys(std::size_t n, std::mt19937_64& rng) {
+    static const char* const sections[] = { "users", "orders", "products", "search", "static/img", "static/js" };
+    static const char* const actions[] = { "", "/details", "/history", "/settings/notifications", "/edit" };
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string k = "https://example.com/api/v";
+        k += std::to_string(rng() % 3 + 1);
+        k += '/';
+        k += sections[rng() % 6];
+        k += '/';
+        k += std::to_string(rng() % (n * 4));
+        k += actions[rng() % 5];
+        keys.push_back(std::move(k));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+std::size_t count_prefix(const art_map<string_or_view, int>& m, std::string_view prefix) {
+    std::size_t count = 0;
+    for (const auto& kv : m.prefix_range(prefix)) count += static_cast<std::size_t>(kv.second);
+    return count;
+}
+
+std::size_t count_prefix(const std_map& m, std::string_view prefix) {
+    std::size_t count = 0;
+    for (auto it = m.lower_bound(prefix); it != m.end() && it->first.get().substr(0, prefix.size()) == prefix; ++it) count += static_cast<std::size_t>(it->second);
+    return count;
+}
+
+std::size_t count_prefix(const sorted_vector& v, std::string_view prefix) {
+    std::size_t count = 0;
+    auto it = std::lower_bound(v.begin(), v.end(), prefix, [](const auto& kv, std::string_view k) { return kv.first.get() < k; });
+    for (; it != v.end() && it->first.get().substr(0, prefix.size()) == prefix; ++it) count += static_cast<std::size_t>(it->second);
+    return count;
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = count_from_args(argc, argv, 1000000);
+    std::mt19937_64 rng(42);
+    std::vector<std::string> keys = make_keys(n, rng);
+    std::vector<std::string> lookups(keys.begin(), keys.end());
+    std::shuffle(lookups.begin(), lookups.end(), rng);
+    // Prefixes ending in the middle of the numeric id, each matching a small range of keys
+    std::vector<std::string> prefixes;
+    for (std::size_t i = 0; i < 10000 && i < keys.size(); ++i) {
+        const std::string& k = keys[rng() % keys.size()];
+        prefixes.push_back(k.substr(0, k.find('/', 40) == std::string::npos ? k.size() - 2 : k.find('/', 40) - 2));
+    }
+    std::printf("%zu keys, %zu lookups, %zu prefix scans\n", keys.size(), lookups.size(), prefixes.size());
+
+    art_map<string_or_view, int> art;
+    std_map map;
+    sorted_vector vec;
+
+    double baseline = time_ms([&] {
+        map = std_map();
+        for (const std::string& k : keys) map.try_emplace(string_or_view(std::string_view(k)), 1);
+    }, 1);
+    report("build std::map", baseline, baseline);
+    report("build art_map", time_ms([&] {
+        art.clear();
+        for (const std::string& k : keys) art.try_emplace(string_or_view(std::string_view(k)), 1);
+    }, 1), baseline);
+    report("build sorted std::vector", time_ms([&] {
+        vec.clear();
+        for (const std::string& k : keys) vec.emplace_back(std::string_view(k), 1);
+        std::sort(vec.begin(), vec.end(), [](const auto& l, const auto& r) { return l.first.get() < r.first.get(); });
+    }, 1), baseline);
+
+    std::size_t sink = 0;
+    baseline = time_ms([&] { for (const std::string& k : lookups) sink += map.find(std::string_view(k))->second; });
+    report("find std::map", baseline, baseline);
+    report("find art_map", time_ms([&] { for (const std::string& k : lookups) sink += art.find(k)->second; }), baseline);
+    report("find sorted std::vector", time_ms([&] {
+        for (const std::string& k : lookups) {
+            sink += std::lower_bound(vec.begin(), vec.end(), std::string_view(k), [](const auto& kv, std::string_view key) { return kv.first.get() < key; })->second;
+        }
+    }), baseline);
+
+    baseline = time_ms([&] { for (const std::string& p : prefixes) sink += count_prefix(map, p); });
+    report("prefix scan std::map", baseline, baseline);
+    report("prefix scan art_map", time_ms([&] { for (const std::string& p : prefixes) sink += count_prefix(art, p); }), baseline);
+    report("prefix scan sorted std::vector", time_ms([&] { for (const std::string& p : prefixes) sink += count_prefix(vec, p); }), baseline);
+
+    baseline = time_ms([&] { for (const auto& kv : map) sink += static_cast<std::size_t>(kv.second); });
+    report("full ordered scan std::map", baseline, baseline);
+    report("full ordered scan art_map", time_ms([&] { for (const auto& kv : art) sink += static_cast<std::size_t>(kv.second); }), baseline);
+    report("full ordered scan sorted std::vector", time_ms([&] { for (const auto& kv : vec) sink += static_cast<std::size_t>(kv.second); }), baseline);
+
+    do_not_optimize(sink);
+}
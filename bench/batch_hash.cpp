@@ -0,0 +1,113 @@
+// Hashing and looking up batches of 1024 string_or_view keys in an open addressing table much larger than the cache:
+// one key at a time (std::hash, string_or_view_hash) vs hash_batch and batch_lookup (hashing a chunk first, then prefetching ahead)
+//
+// Usage: string_or_view_bench_batch_hash [key count = 2000000]
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_hash.h"
+#include "bench_util.h"
+
+// Linear probing, keys are views into strings that outlive the table
+class table {
+public:
+    explicit table(std::size_t capacity_pow2) : slots(capacity_pow2), mask(capacity_pow2 - 1) {}
+
+    void insert(std::string_view key, std::size_t hash, std::uint32_t value) {
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            if (!slots[i].data) {
+                slots[i] = { hash, key.data(), static_cast<std::uint32_t>(key.size()), value };
+                return;
+            }
+        }
+    }
+
+    [[nodiscard]] std::uint32_t find(std::string_view key, std::size_t hash) const noexcept {
+        for (std::size_t i = hash & mask; slots[i].data; i = (i + 1) & mask) {
+            const slot& s = slots[i];
+            if (s.hash == hash && std::string_view(s.data, s.size) == key) return s.value;
+        }
+        return 0;
+    }
+
+    [[nodiscard]] const void* bucket(std::size_t hash) const noexcept { return &slots[hash & mask]; }
+
+private:
+    struct slot {
+        std::size_t hash;
+        const char* data;
+        std::uint32_t size;
+        std::uint32_t value;
+    };
+
+    std::vector<slot> slots;
+    std::size_t mask;
+};
+
+int main(int argc, char** argv) {
+    std::size_t n = count_from_args(argc, argv, 2000000);
+    constexpr std::size_t batch = 1024;
+    std::mt19937_64 rng(11);
+    std::vector<std::string> strings;
+    strings.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) strings.push_back("tenant-" + std::to_string(rng() % 1000) + "/object/" + std::to_string(i) + (i % 3 ? "/meta" : ""));
+
+    std::size_t capacity = 1;
+    while (capacity < 2 * n) capacity *= 2;
+    table t(capacity);
+    for (std::size_t i = 0; i < n; ++i) t.insert(strings[i], string_or_view_hash()(std::string_view(strings[i])), static_cast<std::uint32_t>(i + 1));
+
+    std::vector<string_or_view> keys;
+    keys.reserve(n / batch * batch);
+    for (std::size_t i = 0; i < n / batch * batch; ++i) keys.emplace_back(std::string_view(strings[rng() % n]));
+    std::vector<std::size_t> hashes(batch);
+    std::printf("%zu lookups in batches of %zu, %zu slot table\n", keys.size(), batch, capacity);
+
+    std::size_t sink = 0;
+    double baseline = time_ms([&] {
+        for (const string_or_view& k : keys) sink += std::hash<string_or_view>()(k);
+    });
+    report("hash std::hash<string_or_view>", baseline, baseline);
+    report("hash string_or_view_hash", time_ms([&] {
+        for (const string_or_view& k : keys) sink += string_or_view_hash()(k);
+    }), baseline);
+    report("hash hash_batch (std::hash)", time_ms([&] {
+        for (std::size_t base = 0; base < keys.size(); base += batch) {
+            hash_batch(keys.data() + base, batch, hashes.data());
+            sink += hashes[batch - 1];
+        }
+    }), baseline);
+    report("hash hash_batch (string_or_view_hash)", time_ms([&] {
+        for (std::size_t base = 0; base < keys.size(); base += batch) {
+            hash_batch(keys.data() + base, batch, hashes.data(), string_or_view_hash());
+            sink += hashes[batch - 1];
+        }
+    }), baseline);
+
+    baseline = time_ms([&] {
+        for (const string_or_view& k : keys) sink += t.find(*k, string_or_view_hash()(k));
+    });
+    report("lookup one at a time", baseline, baseline);
+    report("lookup hash_batch, no prefetch", time_ms([&] {
+        for (std::size_t base = 0; base < keys.size(); base += batch) {
+            hash_batch(keys.data() + base, batch, hashes.data(), string_or_view_hash());
+            for (std::size_t i = 0; i < batch; ++i) sink += t.find(*keys[base + i], hashes[i]);
+        }
+    }), baseline);
+    report("lookup batch_lookup (prefetch 8 ahead)", time_ms([&] {
+        for (std::size_t base = 0; base < keys.size(); base += batch) {
+            batch_lookup(keys.data() + base, batch,
+                [&](std::size_t hash) { return t.bucket(hash); },
+                [&](std::size_t i, std::size_t hash) { sink += t.find(*keys[base + i], hash); }, 8, string_or_view_hash());
+        }
+    }), baseline);
+
+    do_not_optimize(sink);
+}
@@ -0,0 +1,42 @@
+#ifndef STRING_OR_VIEW_BENCH_UTIL_H
+#define STRING_OR_VIEW_BENCH_UTIL_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+
+// Keep the compiler from optimizing away a computed value
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+// Best of `repeats` runs of f(), in milliseconds
+template<typename F>
+double time_ms(F&& f, int repeats = 3) {
+    double best = 0;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+inline void report(const char* name, double ms, double baseline_ms) {
+    std::printf("%-48s %10.2f ms  (%.2fx)\n", name, ms, baseline_ms / ms);
+}
+
+// First command line argument as a count, or `default_count`
+inline std::size_t count_from_args(int argc, char** argv, std::size_t default_count) {
+    return argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : default_count;
+}
+
+#endif  // STRING_OR_VIEW_BENCH_UTIL_H
@@ -0,0 +1,127 @@
+// Case-insensitive strings: a hand-written one character at a time char_traits and case folding FNV-1a hash vs
+// ascii_ci_char_traits and its hash, for compare, find and std::unordered_map lookups
+//
+// Usage: string_or_view_bench_ci_traits [key count = 1000000]
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_ci.h"
+#include "bench_util.h"
+
+namespace {
+
+    char scalar_fold(char c) noexcept { return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c; }
+
+    struct scalar_ci_char_traits : std::char_traits<char> {
+        static bool eq(char l, char r) noexcept { return scalar_fold(l) == scalar_fold(r); }
+        static bool lt(char l, char r) noexcept { return static_cast<unsigned char>(scalar_fold(l)) < static_cast<unsigned char>(scalar_fold(r)); }
+        static int compare(const char* l, const char* r, std::size_t n) noexcept {
+            for (std::size_t i = 0; i != n; ++i) {
+                if (!eq(l[i], r[i])) return lt(l[i], r[i]) ? -1 : 1;
+            }
+            return 0;
+        }
+        static const char* find(const char* p, std::size_t n, const char& c) noexcept {
+            for (std::size_t i = 0; i != n; ++i) {
+                if (eq(p[i], c)) return p + i;
+            }
+            return nullptr;
+        }
+    };
+
+    using scalar_ci_string_or_view = string_or_view::replace_traits<scalar_ci_char_traits>;
+
+    struct scalar_ci_hash {
+        std::size_t operator()(const scalar_ci_string_or_view& s) const noexcept {
+            std::uint64_t h = 0xCBF29CE484222325u;
+            for (char c : *s) h = (h ^ static_cast<unsigned char>(scalar_fold(c))) * 0x100000001B3u;
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+    std::string random_case(std::string s, std::mt19937_64& rng) {
+        for (char& c : s) {
+            if (((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) && rng() % 2) c = static_cast<char>(c ^ 0x20);
+        }
+        return s;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = count_from_args(argc, argv, 1000000);
+    std::mt19937_64 rng(5);
+    static const char* const names[] = { "Content-Type", "Content-Length", "Accept-Encoding", "X-Forwarded-For", "Cache-Control", "Authorization",
+        "X-Request-Id", "User-Agent", "Strict-Transport-Security", "Access-Control-Allow-Origin" };
+    // Header names, and DNS names of 20 to 60 bytes
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % 2) keys.push_back(std::string(names[i % 10]) + "-" + std::to_string(i));
+        else keys.push_back("host-" + std::to_string(i) + ".eu-west-" + std::to_string(rng() % 4) + ".compute.internal.example.com");
+    }
+    // Each query is a key with the case of its letters changed at random
+    std::vector<std::size_t> query_keys(n);
+    std::vector<std::string> queries;
+    queries.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        query_keys[i] = static_cast<std::size_t>(rng() % n);
+        queries.push_back(random_case(keys[query_keys[i]], rng));
+    }
+
+    std::size_t sink = 0;
+    double baseline = time_ms([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& key = keys[query_keys[i]];
+            sink += static_cast<std::size_t>(scalar_ci_char_traits::compare(key.data(), queries[i].data(), key.size()) + 1);
+        }
+    });
+    report("compare (equal) scalar", baseline, baseline);
+    report("compare (equal) ascii_ci_char_traits", time_ms([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& key = keys[query_keys[i]];
+            sink += static_cast<std::size_t>(ascii_ci_char_traits::compare(key.data(), queries[i].data(), key.size()) + 1);
+        }
+    }), baseline);
+
+    baseline = time_ms([&] {
+        for (const std::string& q : queries) sink += std::basic_string_view<char, scalar_ci_char_traits>(q.data(), q.size()).find('I');
+    });
+    report("find scalar", baseline, baseline);
+    report("find ascii_ci_char_traits", time_ms([&] {
+        for (const std::string& q : queries) sink += ci_string_view(q.data(), q.size()).find('I');
+    }), baseline);
+
+    baseline = time_ms([&] {
+        for (const std::string& q : queries) sink += scalar_ci_hash()(scalar_ci_string_or_view(std::basic_string_view<char, scalar_ci_char_traits>(q.data(), q.size())));
+    });
+    report("hash scalar (FNV-1a)", baseline, baseline);
+    report("hash std::hash<ci_string_or_view>", time_ms([&] {
+        for (const std::string& q : queries) sink += std::hash<ci_string_or_view>()(ci_string_or_view(ci_string_view(q.data(), q.size())));
+    }), baseline);
+
+    std::unordered_map<scalar_ci_string_or_view, std::size_t, scalar_ci_hash> scalar_map;
+    std::unordered_map<ci_string_or_view, std::size_t> ci_map;
+    scalar_map.reserve(n);
+    ci_map.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        scalar_map.emplace(std::basic_string_view<char, scalar_ci_char_traits>(keys[i].data(), keys[i].size()), i);
+        ci_map.emplace(ci_string_view(keys[i].data(), keys[i].size()), i);
+    }
+    baseline = time_ms([&] {
+        for (const std::string& q : queries) sink += scalar_map.find(std::basic_string_view<char, scalar_ci_char_traits>(q.data(), q.size()))->second;
+    });
+    report("unordered_map lookup scalar", baseline, baseline);
+    report("unordered_map lookup ci_string_or_view", time_ms([&] {
+        for (const std::string& q : queries) sink += ci_map.find(ci_string_view(q.data(), q.size()))->second;
+    }), baseline);
+
+    do_not_optimize(sink);
+}
@@ -0,0 +1,73 @@
+// Storing many small strings: std::vector<string_or_view> (owning elements) vs string_or_view_column (copied into one buffer),
+// comparing memory, fill time, a full scan and random access
+//
+// Usage: string_or_view_bench_column [element count = 10000000]
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_column.h"
+#include "bench_util.h"
+
+int main(int argc, char** argv) {
+    std::size_t n = count_from_args(argc, argv, 10000000);
+    // Short strings (mostly within the small string buffer) with a few longer ones
+    std::vector<std::string> source;
+    source.reserve(n);
+    std::mt19937_64 rng(7);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string s = "id-" + std::to_string(rng() % 1000000);
+        if (i % 16 == 0) s += "-with-a-longer-suffix";
+        source.push_back(std::move(s));
+    }
+    std::vector<std::size_t> random_indices(n);
+    for (std::size_t& i : random_indices) i = static_cast<std::size_t>(rng() % n);
+
+    std::vector<string_or_view> vec;
+    string_or_view_column<string_or_view> column;
+
+    double baseline = time_ms([&] {
+        vec = std::vector<string_or_view>();
+        vec.reserve(n);
+        for (const std::string& s : source) vec.emplace_back(std::string(s));
+    }, 1);
+    report("fill std::vector<string_or_view>", baseline, baseline);
+    report("fill string_or_view_column (append_copy)", time_ms([&] {
+        column.clear();
+        column.append_copy(source.begin(), source.end());
+    }, 1), baseline);
+
+    std::size_t heap = 0;
+    for (const string_or_view& s : vec) {
+        if (s->size() > std::string().capacity()) heap += s->size() + 1;
+    }
+    std::printf("%-48s %10.1f bytes/element\n", "memory std::vector<string_or_view>", static_cast<double>(vec.capacity() * sizeof(string_or_view) + heap) / static_cast<double>(n));
+    std::printf("%-48s %10.1f bytes/element (%.1f of it string data)\n", "memory string_or_view_column",
+        static_cast<double>(column.memory_usage()) / static_cast<double>(n), static_cast<double>(column.payload_size()) / static_cast<double>(n));
+
+    std::size_t sink = 0;
+    baseline = time_ms([&] {
+        for (const string_or_view& s : vec) sink += s->size() + static_cast<unsigned char>(s->back());
+    });
+    report("scan std::vector<string_or_view>", baseline, baseline);
+    report("scan string_or_view_column", time_ms([&] {
+        for (std::string_view s : column) sink += s.size() + static_cast<unsigned char>(s.back());
+    }), baseline);
+
+    baseline = time_ms([&] {
+        for (std::size_t i : random_indices) sink += vec[i]->size() + static_cast<unsigned char>(vec[i]->front());
+    });
+    report("random access std::vector<string_or_view>", baseline, baseline);
+    report("random access string_or_view_column", time_ms([&] {
+        for (std::size_t i : random_indices) {
+            std::string_view s = column[i];
+            sink += s.size() + static_cast<unsigned char>(s.front());
+        }
+    }), baseline);
+
+    do_not_optimize(sink);
+}
@@ -0,0 +1,94 @@
+// Parsing records out of a buffer that is refilled for every batch, where a few fields are kept after the buffer is reused:
+// making every field owning up front vs guarded views that are promoted (all at once) only if still alive at the refill
+//
+// Usage: string_or_view_bench_guard [refill count = 20000]
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_guard.h"
+#include "bench_util.h"
+
+namespace {
+
+    constexpr std::size_t fields_per_fill = 512;
+
+    // "field=<value>\n" lines, with values long enough not to fit in a small string buffer
+    void fill(std::string& buffer, std::mt19937_64& rng) {
+        buffer.clear();
+        for (std::size_t i = 0; i < fields_per_fill; ++i) {
+            buffer += "field=";
+            std::size_t n = 20 + rng() % 40;
+            for (std::size_t j = 0; j < n; ++j) buffer += static_cast<char>('a' + rng() % 26);
+            buffer += '\n';
+        }
+    }
+
+    // Calls f(value) for each line's value
+    template<typename F>
+    void parse(std::string_view buffer, F&& f) {
+        while (!buffer.empty()) {
+            std::size_t eol = buffer.find('\n');
+            f(buffer.substr(6, eol - 6));
+            buffer.remove_prefix(eol + 1);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t fills = count_from_args(argc, argv, 20000);
+    // Precompute the refills so that only parsing and keeping the fields is timed
+    std::mt19937_64 rng(9);
+    std::vector<std::string> contents(64);
+    for (std::string& c : contents) fill(c, rng);
+    std::printf("%zu refills of %zu fields, keeping 1 in 32 fields until the next 16 refills\n", fills, fields_per_fill);
+
+    std::size_t sink = 0;
+    std::string buffer;
+    double baseline = time_ms([&] {
+        std::vector<string_or_view> kept;
+        std::vector<string_or_view> fields;
+        for (std::size_t r = 0; r < fills; ++r) {
+            buffer = contents[r % contents.size()];
+            fields.clear();
+            parse(buffer, [&](std::string_view v) {
+                fields.emplace_back(v);
+                fields.back().make_owning();
+            });
+            for (std::size_t i = 0; i < fields.size(); ++i) {
+                sink += fields[i]->size();
+                if (i % 32 == 0) kept.push_back(std::move(fields[i]));
+            }
+            if (r % 16 == 15) kept.clear();
+        }
+        sink += kept.size();
+    }, 1);
+    report("make_owning every field", baseline, baseline);
+
+    report("source_guard, promote survivors", time_ms([&] {
+        using guarded = guarded_string_or_view<string_or_view>;
+        std::vector<guarded> kept;
+        std::vector<guarded> fields;
+        source_guard<string_or_view> guard;
+        for (std::size_t r = 0; r < fills; ++r) {
+            fields.clear();
+            guard.promote();  // Copies out the kept fields still viewing the buffer, before it is refilled
+            buffer = contents[r % contents.size()];
+            guard.reset(buffer);
+            parse(buffer, [&](std::string_view v) { fields.push_back(guard.view(v)); });
+            for (std::size_t i = 0; i < fields.size(); ++i) {
+                sink += fields[i]->size();
+                if (i % 32 == 0) kept.push_back(std::move(fields[i]));
+            }
+            if (r % 16 == 15) kept.clear();
+        }
+        sink += kept.size();
+    }, 1), baseline);
+
+    do_not_optimize(sink);
+}
@@ -0,0 +1,46 @@
+// Growing a vector of string_or_view one push_back at a time (no reserve), and erasing from the front of a large one:
+// std::vector (move construct + destroy on every reallocation) vs relocating_vector (relocate_at / memmove).
+// Only faster where is_trivially_relocatable<string_or_view> (not on libstdc++, where both do the same work and differ by noise)
+//
+// Usage: string_or_view_bench_relocate [element count = 10000000]
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_relocate.h"
+#include "bench_util.h"
+
+template<typename Vector>
+void grow(std::size_t n) {
+    Vector v;
+    for (std::size_t i = 0; i < n; ++i) {
+        // Half viewing, half owning short strings
+        if (i % 2) v.emplace_back("a string literal");
+        else v.emplace_back(std::to_string(i));
+    }
+    do_not_optimize(v.data());
+}
+
+template<typename Vector>
+void erase_front(std::size_t n) {
+    Vector v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) v.emplace_back(i % 2 ? string_or_view("a string literal") : string_or_view(std::to_string(i)));
+    for (int i = 0; i < 20; ++i) v.erase(v.begin(), v.begin() + 16);
+    do_not_optimize(v.data());
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = count_from_args(argc, argv, 10000000);
+    std::printf("%zu elements, is_trivially_relocatable<string_or_view>: %d\n", n, static_cast<int>(is_trivially_relocatable<string_or_view>::value));
+
+    double baseline = time_ms([&] { grow<std::vector<string_or_view>>(n); });
+    report("grow std::vector<string_or_view>", baseline, baseline);
+    report("grow relocating_vector<string_or_view>", time_ms([&] { grow<relocating_vector<string_or_view>>(n); }), baseline);
+
+    baseline = time_ms([&] { erase_front<std::vector<string_or_view>>(n); });
+    report("fill + erase front x20 std::vector", baseline, baseline);
+    report("fill + erase front x20 relocating_vector", time_ms([&] { erase_front<relocating_vector<string_or_view>>(n); }), baseline);
+}
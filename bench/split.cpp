@@ -0,0 +1,89 @@
+// Splitting lines of fields with split() vs a std::string_view::find / find_first_of loop, for a single code unit delimiter,
+// a split_any_of set and a substring delimiter, at a few field lengths
+//
+// Usage: string_or_view_bench_split [total size in MB = 64]
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "string_or_view.h"
+#include "string_or_view_split.h"
+#include "bench_util.h"
+
+namespace {
+
+    // Fields of `field_size` +- 25% letters, separated by `delimiter`, about `total` bytes
+    std::string make_input(std::size_t total, std::size_t field_size, std::string_view delimiter, std::mt19937_64& rng) {
+        std::string s;
+        s.reserve(total + field_size * 2);
+        while (s.size() < total) {
+            std::size_t n = field_size * 3 / 4 + rng() % (field_size / 2 + 1);
+            for (std::size_t i = 0; i < n; ++i) s += static_cast<char>('a' + rng() % 26);
+            s += delimiter;
+        }
+        return s;
+    }
+
+    // Sum of the piece sizes and the piece count, so that every piece is used
+    template<typename Range>
+    std::size_t consume(const Range& pieces) {
+        std::size_t sink = 0;
+        for (string_or_view piece : pieces) sink += piece->size() + 1;
+        return sink;
+    }
+
+    template<typename Find>
+    std::size_t consume_loop(std::string_view s, std::size_t delimiter_size, Find find) {
+        std::size_t sink = 0;
+        std::size_t pos = 0;
+        while (true) {
+            std::size_t next = find(s, pos);
+            if (next == s.npos) next = s.size();
+            sink += s.substr(pos, next - pos).size() + 1;
+            if (next == s.size()) break;
+            pos = next + delimiter_size;
+        }
+        return sink;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t total = count_from_args(argc, argv, 64) << 20;
+    std::mt19937_64 rng(11);
+    std::size_t sink = 0;
+
+    for (std::size_t field_size : { 12, 40, 200 }) {
+        std::printf("%zu MB, fields of about %zu bytes\n", total >> 20, field_size);
+
+        std::string commas = make_input(total, field_size, ",", rng);
+        double baseline = time_ms([&] { sink += consume_loop(commas, 1, [](std::string_view s, std::size_t pos) { return s.find(',', pos); }); });
+        report("  ','  string_view::find", baseline, baseline);
+        // What split used to find a single code unit, before it used memchr
+        report("  ','  find_first(byte_eq_pred)", time_ms([&] {
+            sink += consume_loop(commas, 1, [](std::string_view s, std::size_t pos) {
+                return pos + string_or_view_detail::find_first(reinterpret_cast<const unsigned char*>(s.data()) + pos, s.size() - pos, string_or_view_detail::byte_eq_pred{ ',' });
+            });
+        }), baseline);
+        report("  ','  split", time_ms([&] { sink += consume(split(std::string_view(commas), ',')); }), baseline);
+
+        // Every other delimiter is a tab
+        std::string mixed = make_input(total, field_size, ";", rng);
+        bool tab = false;
+        for (char& c : mixed) {
+            if (c == ';' && (tab = !tab)) c = '\t';
+        }
+        baseline = time_ms([&] { sink += consume_loop(mixed, 1, [](std::string_view s, std::size_t pos) { return s.find_first_of(" \t;", pos); }); });
+        report("  any of \" \\t;\"  string_view::find_first_of", baseline, baseline);
+        report("  any of \" \\t;\"  split", time_ms([&] { sink += consume(split(std::string_view(mixed), split_any_of(" \t;"))); }), baseline);
+
+        std::string colons = make_input(total, field_size, "::", rng);
+        baseline = time_ms([&] { sink += consume_loop(colons, 2, [](std::string_view s, std::size_t pos) { return s.find("::", pos); }); });
+        report("  \"::\"  string_view::find", baseline, baseline);
+        report("  \"::\"  split", time_ms([&] { sink += consume(split(std::string_view(colons), std::string_view("::"))); }), baseline);
+    }
+
+    do_not_optimize(sink);
+}
@@ -0,0 +1,1086 @@
+// Compares the companion headers against simple reference implementations on random inputs.
+// Built and run by ctest as string_or_view_check. Prints each failure and exits with a non-zero status if there were any
+//
+// Usage: string_or_view_check [iterations = 20000]
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_transform.h"
+#include "string_or_view_split.h"
+#include "string_or_view_sort.h"
+#include "string_or_view_ci.h"
+#include "string_or_view_column.h"
+#include "string_or_view_art.h"
+#include "string_or_view_hash.h"
+#include "string_or_view_guard.h"
+#include "string_or_view_relocate.h"
+
+namespace {
+
+    std::size_t failures = 0;
+
+    template<typename CharT>
+    std::string printable(std::basic_string_view<CharT> s) {
+        std::string result;
+        for (CharT c : s) {
+            auto u = static_cast<std::uint_least32_t>(static_cast<std::make_unsigned_t<CharT>>(c));
+            char buf[16];
+            if (u >= 0x20u && u < 0x7Fu && u != 0x5Cu) std::snprintf(buf, sizeof buf, "%c", static_cast<char>(u));
+            else std::snprintf(buf, sizeof buf, "\\x{%lx}", static_cast<unsigned long>(u));
+            result += buf;
+        }
+        return result;
+    }
+
+    template<typename CharT>
+    void check(bool ok, const char* what, std::basic_string_view<CharT> input) {
+        if (ok) return;
+        ++failures;
+        if (failures <= 20) std::printf("FAILED %s on \"%s\"\n", what, printable(input).c_str());
+    }
+
+    // A random string of code units from `alphabet`, so that the interesting code units show up often
+    template<typename CharT>
+    std::basic_string<CharT> random_string(std::mt19937_64& rng, std::string_view alphabet, std::size_t max_size) {
+        std::size_t n = rng() % 8 == 0 ? rng() % (max_size * 4 + 1) : rng() % (max_size + 1);
+        std::basic_string<CharT> s(n, CharT());
+        for (CharT& c : s) c = static_cast<CharT>(static_cast<unsigned char>(alphabet[rng() % alphabet.size()]));
+        return s;
+    }
+
+    // Reference transforms, one code unit at a time
+
+    template<typename CharT>
+    std::uint_least32_t unit(CharT c) { return static_cast<std::uint_least32_t>(static_cast<std::make_unsigned_t<CharT>>(c)); }
+
+    bool is_space(std::uint_least32_t u) { return u == 0x20u || (u >= 0x09u && u <= 0x0Du); }
+
+    int hex(std::uint_least32_t u) {
+        if (u >= '0' && u <= '9') return static_cast<int>(u - '0');
+        if (u >= 'a' && u <= 'f') return static_cast<int>(u - 'a' + 10);
+        if (u >= 'A' && u <= 'F') return static_cast<int>(u - 'A' + 10);
+        return -1;
+    }
+
+    template<typename CharT>
+    std::basic_string<CharT> reference_case(std::basic_string_view<CharT> s, bool lower) {
+        std::basic_string<CharT> r(s);
+        for (CharT& c : r) {
+            std::uint_least32_t u = unit(c);
+            if (lower && u >= 'A' && u <= 'Z') c = static_cast<CharT>(u + 0x20u);
+            if (!lower && u >= 'a' && u <= 'z') c = static_cast<CharT>(u - 0x20u);
+        }
+        return r;
+    }
+
+    template<typename CharT>
+    std::basic_string<CharT> reference_collapse(std::basic_string_view<CharT> s) {
+        std::basic_string<CharT> r;
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            if (!is_space(unit(s[i]))) r += s[i];
+            else if (i == 0 || !is_space(unit(s[i - 1]))) r += static_cast<CharT>(0x20);
+        }
+        return r;
+    }
+
+    template<typename CharT>
+    std::basic_string<CharT> reference_percent_decode(std::basic_string_view<CharT> s) {
+        std::basic_string<CharT> r;
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            if (unit(s[i]) == '%' && i + 2 < s.size() && hex(unit(s[i + 1])) >= 0 && hex(unit(s[i + 2])) >= 0) {
+                r += static_cast<CharT>(hex(unit(s[i + 1])) * 16 + hex(unit(s[i + 2])));
+                i += 2;
+            } else {
+                r += s[i];
+            }
+        }
+        return r;
+    }
+
+    template<typename CharT>
+    long reference_u_escape(std::basic_string_view<CharT> s, std::size_t i) {
+        if (i + 6 > s.size() || unit(s[i]) != '\\' || unit(s[i + 1]) != 'u') return -1;
+        long v = 0;
+        for (std::size_t j = i + 2; j < i + 6; ++j) {
+            if (hex(unit(s[j])) < 0) return -1;
+            v = v * 16 + hex(unit(s[j]));
+        }
+        return v;
+    }
+
+    template<typename CharT>
+    void reference_encode(std::basic_string<CharT>& r, std::uint_least32_t cp) {
+        if constexpr (sizeof(CharT) == 1) {
+            if (cp < 0x80u) {
+                r += static_cast<CharT>(cp);
+            } else if (cp < 0x800u) {
+                r += static_cast<CharT>(0xC0u | (cp >> 6));
+                r += static_cast<CharT>(0x80u | (cp & 0x3Fu));
+            } else if (cp < 0x10000u) {
+                r += static_cast<CharT>(0xE0u | (cp >> 12));
+                r += static_cast<CharT>(0x80u | ((cp >> 6) & 0x3Fu));
+                r += static_cast<CharT>(0x80u | (cp & 0x3Fu));
+            } else {
+                r += static_cast<CharT>(0xF0u | (cp >> 18));
+                r += static_cast<CharT>(0x80u | ((cp >> 12) & 0x3Fu));
+                r += static_cast<CharT>(0x80u | ((cp >> 6) & 0x3Fu));
+                r += static_cast<CharT>(0x80u | (cp & 0x3Fu));
+            }
+        } else if constexpr (sizeof(CharT) == 2) {
+            if (cp < 0x10000u) {
+                r += static_cast<CharT>(cp);
+            } else {
+                r += static_cast<CharT>(0xD800u | ((cp - 0x10000u) >> 10));
+                r += static_cast<CharT>(0xDC00u | ((cp - 0x10000u) & 0x3FFu));
+            }
+        } else {
+            r += static_cast<CharT>(cp);
+        }
+    }
+
+    template<typename CharT>
+    std::basic_string<CharT> reference_json_unescape(std::basic_string_view<CharT> s) {
+        static const std::string_view from = "\"\\/bfnrt";
+        static const std::string_view to = "\"\\/\b\f\n\r\t";
+        std::basic_string<CharT> r;
+        std::size_t i = 0;
+        while (i < s.size()) {
+            std::size_t simple = i + 1 < s.size() && unit(s[i]) == '\\' && unit(s[i + 1]) < 0x80u ? from.find(static_cast<char>(unit(s[i + 1]))) : from.npos;
+            long u = reference_u_escape(s, i);
+            if (simple != from.npos) {
+                r += static_cast<CharT>(to[simple]);
+                i += 2;
+            } else if (u >= 0) {
+                i += 6;
+                std::uint_least32_t cp = static_cast<std::uint_least32_t>(u);
+                if (cp >= 0xD800u && cp <= 0xDBFFu) {
+                    long low = reference_u_escape(s, i);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000u + ((cp - 0xD800u) << 10) + static_cast<std::uint_least32_t>(low - 0xDC00);
+                        i += 6;
+                    } else {
+                        cp = 0xFFFDu;
+                    }
+                } else if (cp >= 0xDC00u && cp <= 0xDFFFu) {
+                    cp = 0xFFFDu;
+                }
+                reference_encode(r, cp);
+            } else {
+                r += s[i++];
+            }
+        }
+        return r;
+    }
+
+    template<typename CharT>
+    std::basic_string<CharT> reference_trim(std::basic_string_view<CharT> s, bool left, bool right) {
+        while (left && !s.empty() && is_space(unit(s.front()))) s.remove_prefix(1);
+        while (right && !s.empty() && is_space(unit(s.back()))) s.remove_suffix(1);
+        return std::basic_string<CharT>(s);
+    }
+
+    // Checks every overload of `transform` against `reference` on `input`. The trims never allocate (`allocates` is false)
+    template<typename CharT, typename Transform, typename Reference>
+    void check_transform(const char* name, std::basic_string_view<CharT> input, Transform transform, Reference reference, bool allocates = true) {
+        using sov = basic_string_or_view<CharT>;
+        std::basic_string<CharT> expected = reference(input);
+        bool unchanged = expected == input;
+
+        // (1) and (3): a view of the input when unchanged, otherwise an owning copy
+        sov viewing(input);
+        sov from_view = transform(viewing);
+        check(*from_view == expected, name, input);
+        check(unchanged || !allocates ? from_view.is_viewing() : from_view.is_owning(), name, input);
+        check(!unchanged || from_view->data() == input.data(), name, input);
+        sov from_string_view = transform(input);
+        check(*from_string_view == expected, name, input);
+
+        // (1) of an owning string: still a view of it when unchanged
+        sov owning = std::basic_string<CharT>(input);
+        sov from_owning = transform(owning);
+        check(*from_owning == expected && *owning == input, name, input);
+        check(unchanged || !allocates ? from_owning.is_viewing() : from_owning.is_owning(), name, input);
+        check(!unchanged || from_owning->data() == owning->data(), name, input);
+
+        // (2) of an owning string: transformed in place (long enough not to be in the small string buffer, to check it is the same buffer)
+        sov to_move = std::basic_string<CharT>(input);
+        const CharT* buffer = to_move->data();
+        sov moved = transform(static_cast<sov&&>(to_move));
+        check(*moved == expected && moved.is_owning(), name, input);
+        check(input.size() <= 16 || moved->data() == buffer, name, input);
+
+        // (3) of a null terminated pointer (the inputs have no null characters): a view of it when unchanged, still null terminated
+        std::basic_string<CharT> str(input);
+        const CharT* pointer = str.c_str();
+        sov from_pointer = transform(pointer);
+        check(*from_pointer == expected, name, input);
+        check(!unchanged || (from_pointer->data() == pointer && from_pointer.is_null_terminated()), name, input);
+
+        // (4) of a std::basic_string: as (1). (5) of a temporary one: moved in and transformed in place, never a view of the temporary
+        sov from_string = transform(str);
+        check(*from_string == expected && str == input, name, input);
+        check(!unchanged || from_string->data() == str.data(), name, input);
+        std::basic_string<CharT> to_move_string(input);
+        buffer = to_move_string.data();
+        sov from_temporary = transform(static_cast<std::basic_string<CharT>&&>(to_move_string));
+        check(*from_temporary == expected && from_temporary.is_owning(), name, input);
+        check(input.size() <= 16 || from_temporary->data() == buffer, name, input);
+
+        // An unchanged null terminated view stays null terminated
+        std::basic_string<CharT> terminated(input);
+        sov null_terminated{ null_terminated_tag(), std::basic_string_view<CharT>(terminated) };
+        check(!unchanged || transform(null_terminated).is_null_terminated(), name, input);
+    }
+
+// A generic lambda calling every overload of `f`
+#define STRING_OR_VIEW_CHECK_OVERLOADS(f) [](auto&& x) { return f(static_cast<decltype(x)&&>(x)); }
+
+    template<typename CharT>
+    void check_transforms(std::mt19937_64& rng, std::size_t iterations) {
+        using view = std::basic_string_view<CharT>;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            std::basic_string<CharT> s = random_string<CharT>(rng, i % 2 ? "abcxyzAXZ@[`{09" : "abcdefghijklmnopqrstuvwxyz", 80);
+            check_transform<CharT>("ascii_tolower", s, STRING_OR_VIEW_CHECK_OVERLOADS(ascii_tolower), [](view v) { return reference_case(v, true); });
+            check_transform<CharT>("ascii_toupper", s, STRING_OR_VIEW_CHECK_OVERLOADS(ascii_toupper), [](view v) { return reference_case(v, false); });
+
+            s = random_string<CharT>(rng, i % 2 ? "ab \t\n\v\f\r\x1F!" : "abcdefghijklmnopqrstuvwxyz ", 80);
+            check_transform<CharT>("collapse_ascii_whitespace", s, STRING_OR_VIEW_CHECK_OVERLOADS(collapse_ascii_whitespace), [](view v) { return reference_collapse(v); });
+            check_transform<CharT>("ascii_trim", s, STRING_OR_VIEW_CHECK_OVERLOADS(ascii_trim), [](view v) { return reference_trim(v, true, true); }, false);
+            check_transform<CharT>("ascii_trim_left", s, STRING_OR_VIEW_CHECK_OVERLOADS(ascii_trim_left), [](view v) { return reference_trim(v, true, false); }, false);
+            check_transform<CharT>("ascii_trim_right", s, STRING_OR_VIEW_CHECK_OVERLOADS(ascii_trim_right), [](view v) { return reference_trim(v, false, true); }, false);
+
+            s = random_string<CharT>(rng, i % 2 ? "%%%0aF9gG+x" : "abcdefghijklmnopqrstuvwxyz%20", 60);
+            check_transform<CharT>("percent_decode", s, STRING_OR_VIEW_CHECK_OVERLOADS(percent_decode), [](view v) { return reference_percent_decode(v); });
+
+            s = random_string<CharT>(rng, i % 2 ? "\\\\\\uuu\"/bfnrtxdD8C0aF" : "abcdefghijklmnopqrstuvwxyz\\n", 60);
+            check_transform<CharT>("json_unescape", s, STRING_OR_VIEW_CHECK_OVERLOADS(json_unescape), [](view v) { return reference_json_unescape(v); });
+        }
+    }
+
+    // Pieces of `s` between matches of `find(s, pos)` (npos when there are none), `delimiter_size` code units each
+
+    // Overloads (3) to (5) with arguments whose type isn't a string view or basic_string_or_view, and the result types
+    void check_transform_arguments() {
+        std::string_view no_input;
+        static_assert(std::is_same<decltype(ascii_tolower("ABC")), string_or_view>::value, "A string literal gives a string_or_view");
+        static_assert(std::is_same<decltype(ascii_trim(L" x ")), wstring_or_view>::value, "A wide string literal gives a wstring_or_view");
+        static_assert(std::is_same<decltype(ascii_trim(std::pmr::string())), pmr::string_or_view>::value, "A string keeps its allocator");
+        static_assert(std::is_same<decltype(percent_decode(std::declval<const std::u16string&>())), u16string_or_view>::value, "std::u16string gives a u16string_or_view");
+
+        check(*ascii_tolower("ABC") == "abc", "ascii_tolower(string literal)", no_input);
+        string_or_view trimmed = ascii_trim(" x ");
+        check(*trimmed == "x" && trimmed.is_viewing(), "ascii_trim(string literal)", no_input);
+        check(ascii_trim_left(" x").is_null_terminated(), "ascii_trim_left(string literal) is null terminated", no_input);
+        check(*ascii_toupper(L"ab") == L"AB", "ascii_toupper(wide string literal)", no_input);
+        check(*ascii_tolower(u"AB") == u"ab" && *ascii_tolower(U"AB") == U"ab", "ascii_tolower(char16_t and char32_t literals)", no_input);
+        char array[] = "%41%42";
+        check(*percent_decode(array) == "AB", "percent_decode(char array)", no_input);
+        const char* pointer = "  a b  ";
+        check(*collapse_ascii_whitespace(pointer) == " a b ", "collapse_ascii_whitespace(const char*)", no_input);
+        std::string text = "  Some Text  ";
+        check(*ascii_trim(text) == "Some Text" && ascii_trim(text).is_viewing() && ascii_trim(text)->data() == text.data() + 2, "ascii_trim(std::string)", no_input);
+        string_or_view owned = ascii_trim(std::string("  a string too long for the small string buffer  "));
+        check(*owned == "a string too long for the small string buffer" && owned.is_owning(), "ascii_trim(std::string&&)", no_input);
+#ifdef __cpp_char8_t
+        check(*ascii_tolower(u8"AB") == u8"ab", "ascii_tolower(char8_t literal)", no_input);
+#endif
+    }
+
+    template<typename CharT, typename Find>
+    std::vector<std::basic_string<CharT>> reference_split(std::basic_string_view<CharT> s, std::size_t delimiter_size, Find find) {
+        std::vector<std::basic_string<CharT>> pieces;
+        std::size_t pos = 0;
+        while (true) {
+            std::size_t next = delimiter_size == 0 ? s.npos : find(s, pos);
+            if (next == s.npos) {
+                pieces.emplace_back(s.substr(pos));
+                return pieces;
+            }
+            pieces.emplace_back(s.substr(pos, next - pos));
+            pos = next + delimiter_size;
+        }
+    }
+
+    template<typename CharT, typename Range>
+    std::vector<std::basic_string<CharT>> collect(const Range& range) {
+        std::vector<std::basic_string<CharT>> pieces;
+        for (basic_string_or_view<CharT> piece : range) pieces.emplace_back(*piece);
+        return pieces;
+    }
+
+    template<typename CharT>
+    void check_split(std::mt19937_64& rng, std::size_t iterations) {
+        using view = std::basic_string_view<CharT>;
+        using sov = basic_string_or_view<CharT>;
+        const CharT any_of[] = { 0x2C, 0x3B, 0x09, 0 };  // ",;\t"
+        const CharT needles[][4] = { { 0x3A, 0x3A, 0 }, { 0x61, 0x62, 0x61, 0 }, { 0x2C, 0 }, { 0 } };  // "::", "aba", ",", ""
+        for (std::size_t i = 0; i < iterations; ++i) {
+            std::basic_string<CharT> s = random_string<CharT>(rng, i % 2 ? "ab,;:\t" : "abcdefghijklmnopqrstuvwxyz,", 80);
+            view v = s;
+
+            auto expected = reference_split(v, 1, [](view x, std::size_t pos) { return x.find(static_cast<CharT>(0x2C), pos); });
+            check(collect<CharT>(split(v, static_cast<CharT>(0x2C))) == expected, "split(code unit)", v);
+            check(collect<CharT>(split(sov(v), static_cast<CharT>(0x2C))) == expected, "split(code unit) of a view", v);
+            // An owning temporary is kept alive by the range, with pieces viewing it or owning copies
+            check(collect<CharT>(split(sov(s), static_cast<CharT>(0x2C))) == expected, "split(code unit) of an owning temporary", v);
+            std::vector<std::basic_string<CharT>> owned;
+            for (sov piece : split(sov(s), static_cast<CharT>(0x2C), split_pieces::own)) {
+                check(piece.is_owning(), "split_pieces::own", v);
+                owned.emplace_back(*piece);
+            }
+            check(owned == expected, "split_pieces::own", v);
+
+            expected = reference_split(v, 1, [&](view x, std::size_t pos) { return x.find_first_of(any_of, pos); });
+            check(collect<CharT>(split(v, split_any_of(any_of))) == expected, "split(split_any_of)", v);
+
+            for (const CharT* needle : needles) {
+                view n = needle;
+                expected = reference_split(v, n.size(), [&](view x, std::size_t pos) { return x.find(n, pos); });
+                check(collect<CharT>(split(v, n)) == expected, "split(substring)", v);
+            }
+        }
+    }
+
+    // Keys that share long prefixes, repeat often, and include the largest code unit (to check that code units compare unsigned)
+    template<typename CharT>
+    std::vector<std::basic_string<CharT>> random_keys(std::mt19937_64& rng, std::size_t n, std::size_t pattern) {
+        const std::basic_string<CharT> prefix(20, static_cast<CharT>(0x70));
+        const CharT high = static_cast<CharT>(~static_cast<std::make_unsigned_t<CharT>>(0));
+        std::vector<std::basic_string<CharT>> keys(n);
+        for (std::basic_string<CharT>& key : keys) {
+            if (rng() % 4 == 0) key = prefix.substr(0, rng() % (prefix.size() + 1));
+            std::size_t length = rng() % 12;
+            for (std::size_t i = 0; i < length; ++i) key += rng() % 16 == 0 ? high : static_cast<CharT>(0x61 + rng() % 3);
+        }
+        switch (pattern) {
+        case 1: std::sort(keys.begin(), keys.end()); break;
+        case 2: std::sort(keys.begin(), keys.end()); std::reverse(keys.begin(), keys.end()); break;
+        case 3: std::fill(keys.begin(), keys.end(), prefix); break;
+        default: break;
+        }
+        return keys;
+    }
+
+    template<typename CharT>
+    std::vector<basic_string_or_view<CharT>> as_string_or_views(const std::vector<std::basic_string<CharT>>& keys) {
+        // Every other key is owning
+        std::vector<basic_string_or_view<CharT>> result;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (i % 2) result.emplace_back(keys[i]);
+            else result.emplace_back(std::basic_string_view<CharT>(keys[i]));
+        }
+        return result;
+    }
+
+    template<typename CharT>
+    std::vector<std::basic_string<CharT>> as_strings(typename std::vector<basic_string_or_view<CharT>>::const_iterator first, typename std::vector<basic_string_or_view<CharT>>::const_iterator last) {
+        std::vector<std::basic_string<CharT>> result;
+        for (; first != last; ++first) result.emplace_back(**first);
+        return result;
+    }
+
+    template<typename CharT>
+    void check_sort(std::mt19937_64& rng, std::size_t iterations) {
+        std::basic_string_view<CharT> no_input;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            // Every 64th case is big enough to be sorted in parallel
+            std::size_t n = i % 64 == 63 ? 40000 + rng() % 1000 : rng() % 400;
+            std::size_t threads = i % 2 ? 4 : 1;
+            std::vector<std::basic_string<CharT>> keys = random_keys<CharT>(rng, n, i % 5);
+            std::vector<std::basic_string<CharT>> expected = keys;
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<basic_string_or_view<CharT>> sorted = as_string_or_views(keys);
+            string_sort(sorted.begin(), sorted.end(), threads);
+            check(as_strings<CharT>(sorted.begin(), sorted.end()) == expected, "string_sort", no_input);
+
+            // The unique elements are what std::unique keeps, and the rest are the duplicates it would drop
+            std::vector<basic_string_or_view<CharT>> unique = as_string_or_views(keys);
+            auto end = string_sort_unique(unique.begin(), unique.end(), threads);
+            std::vector<std::basic_string<CharT>> duplicates;
+            for (std::size_t j = 1; j < expected.size(); ++j) {
+                if (expected[j] == expected[j - 1]) duplicates.push_back(expected[j]);
+            }
+            expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+            check(as_strings<CharT>(unique.begin(), end) == expected, "string_sort_unique", no_input);
+            std::vector<std::basic_string<CharT>> rest = as_strings<CharT>(end, unique.cend());
+            std::sort(rest.begin(), rest.end());
+            check(rest == duplicates, "string_sort_unique duplicates", no_input);
+        }
+    }
+
+    // Types string_sort can't radix sort fall back to std::sort. Which element of a group of equal ones string_sort_unique keeps is
+    // unspecified (and with ascii_ci_char_traits, equal elements can differ), so this checks that the unique range is strictly increasing
+    // with one element per group, and that the whole range is still the input (no moved-from duplicates)
+    template<typename StringOrView>
+    void check_sort_fallback(std::mt19937_64& rng, std::size_t iterations) {
+        using char_type = typename StringOrView::char_type;
+        using string_type = typename StringOrView::string_type;
+        using exact = std::basic_string<char_type>;
+        static_assert(!string_or_view_detail::can_radix_sort<char_type, typename StringOrView::traits_type>, "Should use the fallback");
+        std::basic_string_view<char_type> no_input;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            std::vector<exact> keys;
+            std::size_t n = rng() % 200;
+            for (std::size_t j = 0; j < n; ++j) keys.push_back(random_string<char_type>(rng, "aAbB", 3));
+
+            std::vector<StringOrView> sorted;
+            for (const exact& key : keys) sorted.emplace_back(string_type(key.data(), key.size()));
+            std::vector<StringOrView> unique = sorted;
+            string_sort(sorted.begin(), sorted.end());
+            check(std::is_sorted(sorted.begin(), sorted.end()), "string_sort fallback", no_input);
+
+            auto end = string_sort_unique(unique.begin(), unique.end());
+            std::size_t groups = static_cast<std::size_t>(std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+            check(static_cast<std::size_t>(end - unique.begin()) == groups, "string_sort_unique fallback count", no_input);
+            check(std::adjacent_find(unique.begin(), end, [](const StringOrView& l, const StringOrView& r) { return !(l < r); }) == end, "string_sort_unique fallback order", no_input);
+            // Every element (the kept ones and the duplicates in the tail) is still one of the input strings
+            std::vector<exact> all;
+            for (const StringOrView& s : unique) all.emplace_back(s->data(), s->size());
+            std::sort(all.begin(), all.end());
+            std::sort(keys.begin(), keys.end());
+            check(all == keys, "string_sort_unique fallback duplicates", no_input);
+        }
+    }
+
+
+    // Counts the bytes it has handed out and its allocations, and throws std::bad_alloc on the `fail_in`th allocation from now when that is
+    // nonzero
+    class counting_resource : public std::pmr::memory_resource {
+    public:
+        std::size_t live = 0;
+        std::size_t allocations = 0;
+        std::size_t fail_in = 0;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            if (fail_in != 0 && --fail_in == 0) throw std::bad_alloc();
+            void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            live += bytes;
+            ++allocations;
+            return p;
+        }
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            live -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // Random pushes (of copies, views, copies of the column's own elements and batches), pops and failed allocations, compared with a
+    // std::vector<std::string> and whether each element should be a view. A push that throws must leave the column as it was
+    void check_column(std::mt19937_64& rng, std::size_t iterations) {
+        using column = string_or_view_column<pmr::string_or_view>;
+        std::vector<std::string> pool;
+        for (std::size_t i = 0; i < 64; ++i) pool.push_back(random_string<char>(rng, "abc", 20));
+        std::string_view no_input;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            counting_resource resource;
+            {
+                column col(&resource);
+                std::vector<std::string> expected;
+                std::vector<bool> expected_views;
+                std::size_t ops = rng() % 300;
+                for (std::size_t op = 0; op < ops; ++op) {
+                    const std::string& s = pool[rng() % pool.size()];
+                    bool fail = rng() % 8 == 0;
+                    if (fail) resource.fail_in = 1 + rng() % 3;
+                    try {
+                        switch (rng() % 7) {
+                        case 0:
+                            col.push_back_copy(s);
+                            expected.push_back(s);
+                            expected_views.push_back(false);
+                            break;
+                        case 1:
+                            col.push_back_view(s);
+                            expected.push_back(s);
+                            expected_views.push_back(true);
+                            break;
+                        case 2:
+                            if (col.empty()) break;
+                            {
+                                // May point into the column's own data buffer
+                                std::size_t j = rng() % col.size();
+                                col.push_back_copy(col[j]);
+                                expected.push_back(expected[j]);
+                                expected_views.push_back(false);
+                            }
+                            break;
+                        case 3: {
+                            bool owning = rng() % 2 == 0;
+                            col.push_back(owning ? pmr::string_or_view(std::pmr::string(s)) : pmr::string_or_view(std::string_view(s)));
+                            expected.push_back(s);
+                            expected_views.push_back(!owning);
+                            break;
+                        }
+                        case 4:
+                            if (col.empty()) break;
+                            col.pop_back();
+                            expected.pop_back();
+                            expected_views.pop_back();
+                            break;
+                        default: {
+                            // Batches only run without failures: elements before the one that threw would stay
+                            resource.fail_in = 0;
+                            // append_views only gets views of the pool, as the owning strings in the batch are about to be destroyed
+                            int kind = static_cast<int>(rng() % 3);
+                            std::vector<pmr::string_or_view> batch;
+                            std::size_t n = rng() % 100;
+                            for (std::size_t j = 0; j < n; ++j) {
+                                const std::string& b = pool[rng() % pool.size()];
+                                bool owning = kind != 1 && rng() % 2 == 0;
+                                batch.push_back(owning ? pmr::string_or_view(std::pmr::string(b)) : pmr::string_or_view(std::string_view(b)));
+                                expected.push_back(b);
+                                expected_views.push_back(kind == 1 || (kind == 2 && !owning));
+                            }
+                            if (kind == 0) col.append_copy(batch.begin(), batch.end());
+                            else if (kind == 1) col.append_views(batch.begin(), batch.end());
+                            else col.append(batch.begin(), batch.end());
+                            break;
+                        }
+                        }
+                    } catch (const std::bad_alloc&) {
+                        check(fail, "column threw without a failed allocation", no_input);
+                    }
+                    resource.fail_in = 0;
+                    check(col.size() == expected.size(), "column size", no_input);
+                }
+
+                bool same = col.size() == expected.size();
+                std::size_t views = 0;
+                std::size_t payload = 0;
+                for (std::size_t j = 0; same && j < col.size(); ++j) {
+                    if (col.is_view(j) != expected_views[j]) same = false;
+                    else if (expected_views[j]) ++views;
+                    else payload += expected[j].size();
+                    if (col[j] != expected[j]) same = false;
+                }
+                check(same, "column elements", no_input);
+                check(col.view_count() == views && col.payload_size() == payload, "column counts", no_input);
+                check(std::equal(col.begin(), col.end(), col.begin()), "column iterators", no_input);
+                // Every buffer comes from the column's allocator
+                check(resource.live == col.memory_usage(), "column allocator", no_input);
+            }
+            check(resource.live == 0, "column leak", no_input);
+        }
+    }
+
+    // A key made of one of a few shared prefixes (some longer than the 8 bytes a node stores inline) and a random tail, with NUL and 0xFF
+    // bytes often, and any byte sometimes so that nodes grow past 4 and 16 children
+    std::string random_art_key(std::mt19937_64& rng) {
+        static const std::string prefixes[] = { "", "a", std::string(20, 'p'), std::string(20, 'p') + std::string(1, '\0') + std::string(19, 'q'), std::string(3, '\xFF') };
+        std::string key = prefixes[rng() % std::size(prefixes)];
+        std::size_t n = rng() % 6;
+        for (std::size_t i = 0; i < n; ++i) key += rng() % 2 == 0 ? std::string_view("ab\0\xFF", 4)[rng() % 4] : static_cast<char>(rng() % 256);
+        return key;
+    }
+
+    // Random inserts, erases and lookups, compared with a std::map
+    void check_art(std::mt19937_64& rng, std::size_t iterations) {
+        using map = art_map<string_or_view, int>;
+        using reference = std::map<std::string, int>;
+        auto same = [](map::const_iterator it, map::const_iterator end, reference::const_iterator rit, reference::const_iterator rend) {
+            if ((it == end) != (rit == rend)) return false;
+            return it == end || (*it->first == rit->first && it->second == rit->second);
+        };
+        for (std::size_t i = 0; i < iterations; ++i) {
+            map m;
+            reference expected;
+            std::size_t ops = rng() % 1000;
+            for (std::size_t op = 0; op < ops; ++op) {
+                std::string key = random_art_key(rng);
+                std::string_view input = key;
+                int value = static_cast<int>(op);
+                switch (rng() % 8) {
+                case 0:
+                case 1: {
+                    bool inserted = m.try_emplace(std::string(key), value).second;
+                    check(inserted == expected.try_emplace(key, value).second, "art_map::try_emplace", input);
+                    break;
+                }
+                case 2:
+                    m.insert_or_assign(std::string(key), value);
+                    expected.insert_or_assign(key, value);
+                    break;
+                case 3:
+                    check(m.erase(key) == expected.erase(key), "art_map::erase(key)", input);
+                    break;
+                case 4: {
+                    // Erase by iterator, at the lower bound of a random key
+                    auto it = m.lower_bound(key);
+                    auto rit = expected.lower_bound(key);
+                    check(same(it, m.end(), rit, expected.end()), "art_map::lower_bound before erase", input);
+                    if (it != m.end() && rit != expected.end()) {
+                        auto next = m.erase(it);
+                        auto rnext = expected.erase(rit);
+                        check(same(next, m.end(), rnext, expected.end()), "art_map::erase(iterator)", input);
+                    }
+                    break;
+                }
+                default: {
+                    check(same(m.find(key), m.end(), expected.find(key), expected.end()), "art_map::find", input);
+                    check(same(m.lower_bound(key), m.end(), expected.lower_bound(key), expected.end()), "art_map::lower_bound", input);
+                    check(same(m.upper_bound(key), m.end(), expected.upper_bound(key), expected.end()), "art_map::upper_bound", input);
+                    // A prefix of the key, which may end inside a compressed path or on a terminal
+                    std::string_view prefix = input.substr(0, rng() % (key.size() + 1));
+                    std::vector<std::string> found;
+                    for (const auto& kv : m.prefix_range(prefix)) found.emplace_back(*kv.first);
+                    std::vector<std::string> wanted;
+                    for (auto it = expected.lower_bound(std::string(prefix)); it != expected.end() && std::string_view(it->first).substr(0, prefix.size()) == prefix; ++it) wanted.push_back(it->first);
+                    check(found == wanted, "art_map::prefix_range", prefix);
+                    break;
+                }
+                }
+            }
+
+            bool equal = m.size() == expected.size();
+            auto rit = expected.begin();
+            for (auto it = m.begin(); equal && it != m.end(); ++it, ++rit) equal = same(it, m.end(), rit, expected.end());
+            // Backwards too, which follows the other leaf links
+            auto rrit = expected.rbegin();
+            for (auto it = m.rbegin(); equal && it != m.rend(); ++it, ++rrit) equal = *it->first == rrit->first;
+            check(equal, "art_map contents", std::string_view());
+        }
+    }
+
+    // hash_batch and batch_lookup against calling the hasher on each key, for std::hash and string_or_view_hash
+    template<typename Key, typename Hash>
+    void check_hash_batch(const std::vector<Key>& keys, const Hash& hash, const char* what) {
+        std::vector<std::size_t> hashes(keys.size());
+        hash_batch(keys.data(), keys.size(), hashes.data(), hash);
+        bool same = true;
+        for (std::size_t i = 0; i < keys.size(); ++i) same = same && hashes[i] == hash(keys[i]);
+        check(same, what, std::string_view());
+
+        std::size_t next = 0;
+        bool in_order = true;
+        batch_lookup(keys.data(), keys.size(), [&](std::size_t) { return keys.data(); },
+            [&](std::size_t i, std::size_t h) { in_order = in_order && i == next++ && h == hash(keys[i]); }, 1 + keys.size() % 10, hash);
+        check(in_order && next == keys.size(), what, std::string_view());
+    }
+
+    template<typename CharT>
+    void check_hash(std::mt19937_64& rng, std::size_t iterations) {
+        using string_type = std::basic_string<CharT>;
+        using view_type = std::basic_string_view<CharT>;
+        using sov = basic_string_or_view<CharT>;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            // Sizes up to 40 bytes and beyond, so every tail length and several 8 byte blocks come up; more than one chunk of batch_lookup
+            std::vector<string_type> strings;
+            std::size_t n = rng() % 600;
+            for (std::size_t j = 0; j < n; ++j) strings.push_back(random_string<CharT>(rng, "ab\x80\xFF", 40 / sizeof(CharT)));
+            std::vector<view_type> views(strings.begin(), strings.end());
+            std::vector<sov> sovs;
+            for (const string_type& s : strings) sovs.push_back(rng() % 2 == 0 ? sov(s) : sov(view_type(s)));
+
+            check_hash_batch(strings, std::hash<string_type>(), "hash_batch std::hash<std::basic_string>");
+            check_hash_batch(views, std::hash<view_type>(), "hash_batch std::hash<std::basic_string_view>");
+            check_hash_batch(sovs, std::hash<sov>(), "hash_batch std::hash<basic_string_or_view>");
+            check_hash_batch(strings, string_or_view_hash(), "hash_batch string_or_view_hash std::basic_string");
+            check_hash_batch(sovs, string_or_view_hash(), "hash_batch string_or_view_hash basic_string_or_view");
+
+            // Without a hasher, hash_batch uses std::hash<Key>
+            std::vector<std::size_t> hashes(sovs.size());
+            hash_batch(sovs.data(), sovs.size(), hashes.data());
+            bool same = true;
+            for (std::size_t j = 0; j < sovs.size(); ++j) {
+                same = same && hashes[j] == std::hash<sov>()(sovs[j]);
+                // string_or_view_hash is transparent
+                same = same && string_or_view_hash()(strings[j]) == string_or_view_hash()(views[j]) && string_or_view_hash()(views[j]) == string_or_view_hash()(sovs[j]);
+            }
+            check(same, "hash_batch default hasher", std::string_view());
+        }
+    }
+
+    // Random views of a buffer registered with a guard (and copied, moved, reassigned, taken and dropped), then the guard promotes them in
+    // one of its ways and the buffer is overwritten: every view still alive must hold its original contents
+    void check_guard(std::mt19937_64& rng, std::size_t iterations) {
+        using guarded = guarded_string_or_view<pmr::string_or_view>;
+        std::string_view no_input;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            counting_resource resource;
+            std::string buffer = random_string<char>(rng, "abcdefgh", 200);
+            std::vector<guarded> views;
+            std::vector<std::string> expected;
+            int how = static_cast<int>(rng() % 5);
+            {
+                source_guard<pmr::string_or_view> guard(buffer, &resource);
+                std::size_t ops = rng() % 100;
+                for (std::size_t op = 0; op < ops; ++op) {
+                    std::size_t pos = rng() % (buffer.size() + 1);
+                    std::size_t j = views.empty() ? 0 : rng() % views.size();
+                    switch (views.empty() ? 0 : rng() % 6) {
+                    case 0:
+                        views.push_back(guard.view(pos, rng() % 40));
+                        expected.push_back(buffer.substr(pos, views.back()->size()));
+                        check(views.back().is_registered(), "source_guard::view registers", no_input);
+                        break;
+                    case 1: {
+                        guarded copy = views[j];
+                        check(copy.is_registered() == views[j].is_registered() && *copy == *views[j], "guarded_string_or_view copy", no_input);
+                        views.push_back(copy);
+                        expected.push_back(expected[j]);
+                        break;
+                    }
+                    case 2: {
+                        guarded moved = std::move(views[j]);
+                        check(views[j]->empty() && !views[j].is_registered(), "guarded_string_or_view moved from", no_input);
+                        views[j] = std::move(moved);
+                        break;
+                    }
+                    case 3: {
+                        pmr::string_or_view taken = views[j].take();
+                        check(*taken == expected[j] && (taken.is_owning() || expected[j].empty()), "guarded_string_or_view::take", no_input);
+                        check(views[j]->empty() && !views[j].is_registered(), "guarded_string_or_view after take", no_input);
+                        views[j] = std::move(taken);
+                        break;
+                    }
+                    case 4:
+                        views[j] = views.back();
+                        expected[j] = expected.back();
+                        views.pop_back();
+                        expected.pop_back();
+                        break;
+                    default:
+                        // A registered view the guard never has to copy
+                        static_cast<void>(guard.view(pos, 0));
+                        break;
+                    }
+                }
+
+                std::size_t before = resource.allocations;
+                if (how == 0) {
+                    guard.promote();
+                } else if (how == 1) {
+                    guard.release();
+                } else if (how == 2) {
+                    guard.reset(buffer);
+                } else if (how == 4) {
+                    // Destroying the guard with the shared allocation failing copies each view instead
+                    resource.fail_in = 1;
+                }
+                if (how <= 2) {
+                    check(!guard.has_dependents(), "source_guard promote unregisters", no_input);
+                    check(resource.allocations - before <= 1, "source_guard promote allocates once", no_input);
+                }
+            }
+            resource.fail_in = 0;
+            std::fill(buffer.begin(), buffer.end(), 'X');
+            bool same = true;
+            for (std::size_t j = 0; j < views.size(); ++j) {
+                same = same && *views[j] == expected[j] && !views[j].is_registered();
+                if (views[j].is_promoted()) same = same && views[j].value().is_null_terminated();
+            }
+            check(same, how == 4 ? "source_guard destructor with a failed allocation" : "source_guard promote", no_input);
+            views.clear();
+            check(resource.live == 0, "source_guard leak", no_input);
+        }
+    }
+
+    unsigned char ascii_lower(unsigned char c) { return c >= 'A' && c <= 'Z' ? static_cast<unsigned char>(c + ('a' - 'A')) : c; }
+
+    // ascii_ci_char_traits::compare and find, and ascii_ci_hash, against folding one byte at a time. Every length up to 80 covers both
+    // sides of the 8, 16 and 32 byte steps, and starting at a random offset makes the loads unaligned. The alphabet has the bytes next to
+    // each range of letters, and the same bytes with the top bit set (which must not fold)
+    void check_ci(std::mt19937_64& rng, std::size_t iterations) {
+        constexpr std::string_view alphabet("aAzZ@[`{\xC1\xE1\xDA\xFA\x80\xFF", 14);
+        for (std::size_t i = 0; i < iterations; ++i) {
+            std::size_t n = i % 81;
+            std::size_t offset = rng() % 32;
+            std::string a(offset + n, '\0');
+            for (char& c : a) c = alphabet[rng() % alphabet.size()];
+            // b is a with the case of some letters flipped and sometimes one byte changed
+            std::string b = a;
+            for (char& c : b) {
+                unsigned char u = ascii_lower(static_cast<unsigned char>(c));
+                if (u >= 'a' && u <= 'z' && rng() % 2 == 0) c = static_cast<char>(static_cast<unsigned char>(c) ^ 0x20u);
+            }
+            if (n != 0 && rng() % 2 == 0) b[offset + rng() % n] = alphabet[rng() % alphabet.size()];
+            const char* l = a.data() + offset;
+            const char* r = b.data() + offset;
+            std::string_view input(l, n);
+
+            int expected = 0;
+            std::string folded(n, '\0');
+            for (std::size_t j = 0; j < n; ++j) {
+                unsigned char x = ascii_lower(static_cast<unsigned char>(l[j]));
+                unsigned char y = ascii_lower(static_cast<unsigned char>(r[j]));
+                folded[j] = static_cast<char>(x);
+                if (expected == 0 && x != y) expected = x < y ? -1 : 1;
+            }
+            int result = ascii_ci_char_traits::compare(l, r, n);
+            check((result < 0 ? -1 : result > 0 ? 1 : 0) == expected, "ascii_ci_char_traits::compare", input);
+
+            char c = alphabet[rng() % alphabet.size()];
+            const char* found = l + n;
+            for (std::size_t j = 0; j < n; ++j) {
+                if (ascii_lower(static_cast<unsigned char>(l[j])) == ascii_lower(static_cast<unsigned char>(c))) {
+                    found = l + j;
+                    break;
+                }
+            }
+            const char* result_find = ascii_ci_char_traits::find(l, n, c);
+            check((result_find ? result_find : l + n) == found, "ascii_ci_char_traits::find", input);
+
+            ci_string_view ci(l, n);
+            check(ascii_ci_hash()(ci) == string_or_view_hash()(std::string_view(folded)), "ascii_ci_hash", input);
+            check((ascii_ci_hash()(ci) == ascii_ci_hash()(ci_string_view(r, n))) || expected != 0, "ascii_ci_hash of equal strings", input);
+            check(std::hash<ci_string_or_view>()(ci_string_or_view(ci)) == ascii_ci_hash()(input), "std::hash<ci_string_or_view>", input);
+        }
+    }
+
+    // Each way is_null_terminated() is set, kept and cleared, and c_str / with_c_str on either side of with_c_str's stack buffer
+    template<typename CharT>
+    void check_null_termination() {
+        using sov = basic_string_or_view<CharT>;
+        using string_type = std::basic_string<CharT>;
+        using view_type = std::basic_string_view<CharT>;
+        static const CharT literal[] = { CharT('a'), CharT('b'), CharT('c'), CharT() };
+        const string_type text(8, CharT('x'));
+        view_type no_input;
+
+        check(sov(literal).is_null_terminated(), "is_null_terminated from const CharT*", no_input);
+        check(sov(null_terminated_tag(), view_type(text.c_str(), text.size())).is_null_terminated(), "is_null_terminated with null_terminated_tag", no_input);
+        check(!sov(view_type(text)).is_null_terminated(), "is_null_terminated from a view", no_input);
+        check(!sov(view_type(text).substr(0, 3)).is_null_terminated(), "is_null_terminated from a view of part of a string", no_input);
+        check(sov(string_type(text)).is_null_terminated(), "is_null_terminated owning", no_input);
+        check(!sov().is_null_terminated() && !sov(nullptr).is_null_terminated(), "is_null_terminated empty", no_input);
+
+        sov terminated = literal;
+        sov unterminated = view_type(text);
+        sov copy = terminated;
+        sov copy_unterminated = unterminated;
+        check(copy.is_null_terminated() && !copy_unterminated.is_null_terminated(), "is_null_terminated copy", no_input);
+        copy = unterminated;
+        copy_unterminated = terminated;
+        check(!copy.is_null_terminated() && copy_unterminated.is_null_terminated(), "is_null_terminated copy assignment", no_input);
+        sov moved = static_cast<sov&&>(copy_unterminated);
+        check(moved.is_null_terminated(), "is_null_terminated move", no_input);
+        moved = sov(view_type(text));
+        check(!moved.is_null_terminated(), "is_null_terminated move assignment", no_input);
+
+        sov x = literal;
+        x.remove_prefix(1);
+        check(x.is_null_terminated() && *x == view_type(literal + 1), "is_null_terminated after remove_prefix", no_input);
+        x.remove_suffix(0);
+        check(x.is_null_terminated(), "is_null_terminated after remove_suffix(0)", no_input);
+        x.remove_suffix(1);
+        check(!x.is_null_terminated(), "is_null_terminated after remove_suffix", no_input);
+        x = literal;
+        x.clear();
+        check(!x.is_null_terminated(), "is_null_terminated after clear", no_input);
+        x = literal;
+        x = view_type(literal);
+        check(!x.is_null_terminated(), "is_null_terminated after assigning a view", no_input);
+        x = literal;
+        static_cast<void>(x.access_underlying_view());
+        check(!x.is_null_terminated(), "is_null_terminated after access_underlying_view", no_input);
+        x = nullptr;
+        check(!x.is_null_terminated(), "is_null_terminated after assigning nullptr", no_input);
+
+        sov l = literal;
+        sov r = view_type(text);
+        swap(l, r);
+        check(!l.is_null_terminated() && r.is_null_terminated() && *r == view_type(literal), "is_null_terminated swap views", no_input);
+        sov owning = string_type(text);
+        swap(owning, r);
+        check(owning.is_null_terminated() && *owning == view_type(literal) && r.is_owning() && *r == text, "is_null_terminated swap with owning", no_input);
+        swap(l, r);
+        check(!r.is_null_terminated() && r.is_viewing(), "is_null_terminated swap owning back", no_input);
+
+        // c_str and with_c_str only copy when needed, and the copy is null terminated. Sizes on each side of the stack buffer
+        constexpr std::size_t inline_capacity = 256 / sizeof(CharT);
+        for (std::size_t n : { std::size_t{0}, std::size_t{1}, inline_capacity - 1, inline_capacity, inline_capacity + 1, 4 * inline_capacity }) {
+            string_type big(n + 1, CharT('y'));
+            view_type piece(big.data(), n);  // Followed by 'y', not a null character
+            sov v = piece;
+            sov t(null_terminated_tag(), view_type(big.c_str(), big.size()));
+            string_type scratch;
+            const CharT* p = v.c_str(scratch);
+            check(p != big.data() && view_type(p) == piece, "c_str copies when not null terminated", piece);
+            check(t.c_str(scratch) == big.data(), "c_str doesn't copy when null terminated", piece);
+            bool ok = v.with_c_str([&](const CharT* q) { return q != big.data() && view_type(q) == piece; });
+            check(ok, "with_c_str copies when not null terminated", piece);
+            ok = t.with_c_str([&](const CharT* q) { return q == big.data(); });
+            check(ok, "with_c_str doesn't copy when null terminated", piece);
+        }
+    }
+
+    // An int on the heap: relocating it bytewise is fine, but copying it bytewise and destroying both would free it twice.
+    // `live` counts the boxes, to catch elements that were lost or duplicated
+    struct boxed {
+        static inline std::size_t live = 0;
+        int* p;
+
+        boxed(int value = 0) : p(new int(value)) { ++live; }
+        boxed(const boxed& other) : p(new int(*other.p)) { ++live; }
+        boxed(boxed&& other) noexcept : p(std::exchange(other.p, nullptr)) { ++live; }
+        boxed& operator=(const boxed& other) { *p = *other.p; return *this; }
+        boxed& operator=(boxed&& other) noexcept { std::swap(p, other.p); return *this; }
+        ~boxed() { delete p; --live; }
+
+        [[nodiscard]] int value() const { return *p; }
+    };
+
+    // Points to itself, so relocating it bytewise would be caught: not trivially relocatable, and relocated by moving
+    struct self_pointing {
+        static inline std::size_t live = 0;
+        static inline bool moved_bytewise = false;
+        const self_pointing* self;
+        int v;
+
+        self_pointing(int value = 0) : self(this), v(value) { ++live; }
+        self_pointing(const self_pointing& other) noexcept : self(this), v(other.get()) { ++live; }
+        self_pointing& operator=(const self_pointing& other) noexcept { v = other.get(); get(); return *this; }
+        ~self_pointing() { get(); --live; }
+
+        int get() const noexcept {
+            if (self != this) moved_bytewise = true;
+            return v;
+        }
+        [[nodiscard]] int value() const noexcept { return get(); }
+    };
+
+}
+
+template<>
+struct is_trivially_relocatable<boxed> : std::true_type {};
+
+namespace {
+
+    // Random push_back, insert (including of one of the vector's own elements), erase, reserve, resize and copies of a relocating_vector,
+    // compared with a std::vector<int>. boxed takes the memmove path and self_pointing the move constructor path
+    template<typename T>
+    void check_relocating_vector(std::mt19937_64& rng, std::size_t iterations, const char* what) {
+        static_assert(is_trivially_relocatable<T>::value == std::is_same<T, boxed>::value, "Each type should take its own path");
+        std::string_view no_input;
+        for (std::size_t i = 0; i < iterations; ++i) {
+            {
+                relocating_vector<T> v;
+                std::vector<int> expected;
+                std::size_t ops = rng() % 200;
+                for (std::size_t op = 0; op < ops; ++op) {
+                    int value = static_cast<int>(rng() % 1000);
+                    std::size_t pos = rng() % (expected.size() + 1);
+                    switch (rng() % 9) {
+                    case 0:
+                        v.push_back(T(value));
+                        expected.push_back(value);
+                        break;
+                    case 1:
+                        v.insert(v.begin() + pos, T(value));
+                        expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(pos), value);
+                        break;
+                    case 2:
+                    case 3: {
+                        // Insert a copy of one of its own elements, sometimes right when the vector is full
+                        if (expected.empty()) break;
+                        if (rng() % 2 == 0) v.shrink_to_fit();
+                        std::size_t j = rng() % expected.size();
+                        v.insert(v.begin() + pos, v[j]);
+                        int copied = expected[j];
+                        expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(pos), copied);
+                        break;
+                    }
+                    case 4: {
+                        if (expected.empty()) break;
+                        std::size_t j = rng() % expected.size();
+                        v.push_back(v[j]);
+                        int copied = expected[j];
+                        expected.push_back(copied);
+                        break;
+                    }
+                    case 5: {
+                        if (expected.empty()) break;
+                        std::size_t first = rng() % expected.size();
+                        std::size_t last = first + rng() % (expected.size() - first + 1);
+                        if (rng() % 2 == 0) last = first + 1;
+                        auto it = v.erase(v.begin() + first, v.begin() + last);
+                        check(it == v.begin() + first, what, no_input);
+                        expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(first), expected.begin() + static_cast<std::ptrdiff_t>(last));
+                        break;
+                    }
+                    case 6: {
+                        std::size_t cap = rng() % 300;
+                        std::size_t before = v.capacity();
+                        v.reserve(cap);
+                        check(v.capacity() >= cap && v.capacity() >= before, what, no_input);
+                        break;
+                    }
+                    case 7: {
+                        std::size_t n = rng() % 100;
+                        v.resize(n);
+                        expected.resize(n);
+                        break;
+                    }
+                    default:
+                        if (rng() % 2 == 0) {
+                            relocating_vector<T> copy(v);
+                            v = std::move(copy);
+                        } else {
+                            relocating_vector<T> moved(std::move(v));
+                            v = moved;
+                        }
+                        break;
+                    }
+                    if (v.size() != expected.size()) break;
+                }
+
+                bool same = v.size() == expected.size() && T::live == v.size();
+                for (std::size_t j = 0; same && j < v.size(); ++j) same = v[j].value() == expected[j];
+                check(same, what, no_input);
+            }
+            check(T::live == 0, what, no_input);
+        }
+        if constexpr (std::is_same<T, self_pointing>::value) check(!T::moved_bytewise, what, no_input);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t iterations = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : 20000;
+    std::mt19937_64 rng(42);
+
+    check_transforms<char>(rng, iterations);
+    check_transforms<char16_t>(rng, iterations / 4);
+    check_transforms<char32_t>(rng, iterations / 4);
+    check_transform_arguments();
+    check_split<char>(rng, iterations);
+    check_split<char16_t>(rng, iterations / 4);
+    check_sort<char>(rng, iterations / 20);
+    check_sort<char16_t>(rng, iterations / 80);
+    check_sort<char32_t>(rng, iterations / 80);
+    check_sort_fallback<ci_string_or_view>(rng, iterations / 20);
+    check_sort_fallback<basic_string_or_view<wchar_t>>(rng, iterations / 20);
+    check_column(rng, iterations / 20);
+    check_art(rng, iterations / 20);
+    check_hash<char>(rng, iterations / 20);
+    check_hash<char16_t>(rng, iterations / 80);
+    check_guard(rng, iterations / 10);
+    check_ci(rng, iterations);
+    check_null_termination<char>();
+    check_null_termination<char16_t>();
+    check_relocating_vector<boxed>(rng, iterations / 20, "relocating_vector, trivially relocatable");
+    check_relocating_vector<self_pointing>(rng, iterations / 20, "relocating_vector, relocated by moving");
+
+    if (failures != 0) {
+        std::printf("%zu checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All checks passed\n");
+}
@@ -2,6 +2,7 @@
 // Reuse STRING_OR_VIEW_UNREACHABLE_DEFAULT macro as header guard
 
 #include <cstddef>
+#include <cstring>
 #include <optional>
 #include <utility>
 #include <string_view>
@@ -74,6 +75,36 @@ constexpr void* operator new(std::size_t, void* ptr, constexpr_new_tag) noexcept
     return ptr;
 }
 
+// Passed to the basic_string_or_view constructor to view a string known to be followed by a null character
+struct null_terminated_tag {
+    constexpr explicit null_terminated_tag() noexcept = default;
+};
+
+// is_trivially_relocatable<T>::value is true if moving a T and then destroying the source can be replaced with a memcpy.
+// Specialize for your own types
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// Whether std::basic_string can be relocated with memcpy. Not true for libstdc++ (short strings point into the string object itself)
+// or for msvc's debug iterators (container proxy points back to the string). Define as 0 or 1 to override
+#ifndef STRING_OR_VIEW_STRING_IS_TRIVIALLY_RELOCATABLE
+#if defined(_LIBCPP_VERSION)
+#define STRING_OR_VIEW_STRING_IS_TRIVIALLY_RELOCATABLE 1
+#elif defined(_MSVC_STL_VERSION) && defined(_ITERATOR_DEBUG_LEVEL) && _ITERATOR_DEBUG_LEVEL == 0
+#define STRING_OR_VIEW_STRING_IS_TRIVIALLY_RELOCATABLE 1
+#else
+#define STRING_OR_VIEW_STRING_IS_TRIVIALLY_RELOCATABLE 0
+#endif
+#endif
+
+// Stateless, so always fine to memcpy (Some implementations have a user-provided copy constructor so aren't trivially copyable)
+template<typename T>
+struct is_trivially_relocatable<std::allocator<T>> : std::true_type {};
+
+template<typename CharT, typename Traits, typename Allocator>
+struct is_trivially_relocatable<std::basic_string<CharT, Traits, Allocator>>
+    : std::integral_constant<bool, STRING_OR_VIEW_STRING_IS_TRIVIALLY_RELOCATABLE && is_trivially_relocatable<Allocator>::value> {};
+
 template<typename CharT, typename Traits = typename std::basic_string<CharT>::traits_type, typename Allocator = typename std::basic_string<CharT, Traits>::allocator_type>
 struct basic_string_or_view {
     using char_type = CharT;
@@ -114,6 +145,7 @@ public:
         case VIEWING:
             // (Self assignment `string_or_view sov = sov;` supported because other is an empty view at this point)
             viewing = other.viewing;
+            view_null_terminated = other.view_null_terminated;
             break;
         case OWNING:
             copy_string_when_holding_view(other.owning);
@@ -126,6 +158,7 @@ public:
         switch (other.tag) {
         case VIEWING:
             viewing = other.viewing;
+            view_null_terminated = other.view_null_terminated;
             break;
         case OWNING:
             viewing.~basic_string_view();
@@ -137,7 +170,9 @@ public:
 
     constexpr basic_string_or_view(string_type&& other) noexcept : owning(static_cast<string_type&&>(other)), tag(OWNING) {}
     constexpr basic_string_or_view(string_view_type other) noexcept : viewing(other), tag(VIEWING) {}
-    constexpr basic_string_or_view(const char_type* other) noexcept(can_noexcept_construct_view_from_char_pointer) : viewing(other, traits_length(other)), tag(VIEWING) {}
+    constexpr basic_string_or_view(const char_type* other) noexcept(can_noexcept_construct_view_from_char_pointer) : viewing(other, traits_length(other)), tag(VIEWING), view_null_terminated(other != nullptr) {}
+    // View `other`, where `other.data()[other.size()]` is a null character (e.g., from `std::basic_string::c_str()` or `argv`)
+    constexpr basic_string_or_view(null_terminated_tag, string_view_type other) noexcept : viewing(other), tag(VIEWING), view_null_terminated(other.data() != nullptr) {}
     constexpr basic_string_or_view(std::nullptr_t) noexcept : basic_string_or_view() {}
 
     template<typename... Args>
@@ -158,6 +193,7 @@ public:
             switch (other.tag) {
             case VIEWING:
                 viewing = other.viewing;
+                view_null_terminated = other.view_null_terminated;
                 break;
             case OWNING:
                 copy_string_when_holding_view(other.owning);
@@ -170,6 +206,7 @@ public:
             case VIEWING:
                 owning.~basic_string();
                 construct_viewing(other.viewing);
+                view_null_terminated = other.view_null_terminated;
                 break;
             case OWNING:
                 owning = other.owning;
@@ -188,6 +225,7 @@ public:
             switch (other.tag) {
             case VIEWING:
                 viewing = other.viewing;
+                view_null_terminated = other.view_null_terminated;
                 break;
             case OWNING:
                 viewing.~basic_string_view();
@@ -201,6 +239,7 @@ public:
             case VIEWING:
                 owning.~basic_string();
                 construct_viewing(other.viewing);
+                view_null_terminated = other.view_null_terminated;
                 break;
             case OWNING:
                 // All other self-assignments are well defined, other than basic_string's move assign
@@ -258,17 +297,21 @@ public:
             break;
         STRING_OR_VIEW_UNREACHABLE_DEFAULT;
         }
+        view_null_terminated = false;
         return *this;
     }
 
     constexpr basic_string_or_view& operator=(const char_type* other) noexcept(can_noexcept_construct_view_from_char_pointer) {
-        return *this = string_view_type(other, traits_length(other));
+        *this = string_view_type(other, traits_length(other));
+        view_null_terminated = other != nullptr;
+        return *this;
     }
 
     constexpr basic_string_or_view& operator=(std::nullptr_t) noexcept {
         switch (tag) {
         case VIEWING:
             viewing = string_view_type();
+            view_null_terminated = false;
             break;
         case OWNING:
             owning.~basic_string();
@@ -353,6 +396,18 @@ public:
         return !is_owning();
     }
 
+    // True if data()[size()] is known to be a null character: always when owning, and when viewing something constructed or assigned
+    // from a `const char_type*` (including string literals) or with `null_terminated_tag`. Removing a suffix makes it false
+    [[nodiscard]] constexpr bool is_null_terminated() const noexcept {
+        switch (tag) {
+        case VIEWING:
+            return view_null_terminated;
+        case OWNING:
+            return true;
+        STRING_OR_VIEW_UNREACHABLE_DEFAULT;
+        }
+    }
+
     [[nodiscard]] constexpr string_view_type operator*() const noexcept {
         switch (tag) {
         case VIEWING:
@@ -416,6 +471,7 @@ public:
             switch (other.tag) {
             case VIEWING:
                 viewing.swap(other.viewing);
+                ::std::swap(view_null_terminated, other.view_null_terminated);
                 break;
             case OWNING:
                 swap_my_viewing_with_other_owning(other);
@@ -555,6 +611,32 @@ public:
         STRING_OR_VIEW_UNREACHABLE_DEFAULT;
         }
     }
+
+    // A null terminated pointer to the characters: data() if is_null_terminated(), otherwise a copy in `scratch`
+    // (which can be reused between calls to avoid allocating)
+    [[nodiscard]] constexpr const_pointer c_str(string_type& scratch) const {
+        if (is_null_terminated()) return data();
+        scratch = viewing;
+        return scratch.c_str();
+    }
+
+    // Returns `f(p)` where `p` is a null terminated pointer to the characters: data() if is_null_terminated(), otherwise a
+    // copy in a stack buffer (or a temporary string if too long). `p` is only valid during the call
+    template<typename F>
+    decltype(auto) with_c_str(F&& f) const {
+        if (is_null_terminated()) return static_cast<F&&>(f)(data());
+        constexpr size_type inline_capacity = 256 / sizeof(char_type);
+        size_type n = viewing.size();
+        if (n < inline_capacity) {
+            char_type buffer[inline_capacity];
+            if (n != 0) traits_type::copy(buffer, viewing.data(), n);
+            traits_type::assign(buffer[n], char_type());
+            return static_cast<F&&>(f)(static_cast<const_pointer>(buffer));
+        }
+        string_type copy(viewing);
+        return static_cast<F&&>(f)(static_cast<const_pointer>(copy.c_str()));
+    }
+
     [[nodiscard]] constexpr size_type size() const noexcept {
         switch (tag) {
         case VIEWING:
@@ -624,6 +706,7 @@ public:
         switch (tag) {
         case VIEWING:
             viewing.remove_suffix(viewing.size());
+            view_null_terminated = false;
             break;
         case OWNING:
             owning.clear();
@@ -636,6 +719,7 @@ public:
         switch (tag) {
         case VIEWING:
             viewing.remove_suffix(::std::min(n, viewing.size()));
+            if (n != 0) view_null_terminated = false;
             break;
         case OWNING: {
             // owning.erase(::std::min(n, owning.size()));
@@ -696,8 +780,9 @@ public:
     [[nodiscard]] constexpr       string_type&& access_underlying_owned()      && noexcept { return static_cast<string_type&&>(owning); }
     [[nodiscard]] constexpr const string_type&  access_underlying_owned() const&  noexcept { return owning; }
     // NOTE: these references can only be used if !is_owning(). Use carefully!
-    [[nodiscard]] constexpr       string_view_type&  access_underlying_view()      &  noexcept { return viewing; }
-    [[nodiscard]] constexpr       string_view_type&& access_underlying_view()      && noexcept { return static_cast<string_view_type&&>(viewing); }
+    // (The non-const overloads forget that the view is null terminated, since it may be changed through the reference)
+    [[nodiscard]] constexpr       string_view_type&  access_underlying_view()      &  noexcept { view_null_terminated = false; return viewing; }
+    [[nodiscard]] constexpr       string_view_type&& access_underlying_view()      && noexcept { view_null_terminated = false; return static_cast<string_view_type&&>(viewing); }
     [[nodiscard]] constexpr const string_view_type&  access_underlying_view() const&  noexcept { return viewing; }
 
 #ifdef __cpp_constexpr_dynamic_alloc
@@ -718,13 +803,37 @@ public:
         tag = static_cast<tag_t>(-1);
     }
 
+    // Move construct *dest from *source and end the lifetime of *source. Cheaper than the move constructor followed by
+    // the destructor: a memcpy if the string type is trivially relocatable, otherwise no empty view is constructed in between
+    friend basic_string_or_view* relocate_at(basic_string_or_view* source, basic_string_or_view* dest) noexcept {
+        if constexpr (is_trivially_relocatable<string_type>::value) {
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(source), sizeof(basic_string_or_view));
+            return dest;
+        } else {
+            switch (source->tag) {
+            case VIEWING:
+                ::new (static_cast<void*>(dest), constexpr_new_tag{0}) basic_string_or_view(source->viewing);
+                dest->view_null_terminated = source->view_null_terminated;
+                break;
+            case OWNING:
+                ::new (static_cast<void*>(dest), constexpr_new_tag{0}) basic_string_or_view(static_cast<string_type&&>(source->owning));
+                source->owning.~basic_string();
+                break;
+            STRING_OR_VIEW_UNREACHABLE_DEFAULT;
+            }
+            return dest;
+        }
+    }
+
 private:
     constexpr void swap_my_viewing_with_other_owning(basic_string_or_view& other) noexcept {
         string_view_type tmp = viewing;
+        bool tmp_null_terminated = view_null_terminated;
         viewing.~basic_string_view();
         construct_owning(static_cast<string_type&&>(other.owning));
         other.owning.~basic_string();
         other.construct_viewing(tmp);
+        other.view_null_terminated = tmp_null_terminated;
     }
 
     constexpr void copy_string_when_holding_view(string_type s) noexcept {
@@ -749,20 +858,27 @@ private:
         static_assert(string_view_type_nothrow_constructible<Args...>() != AllowExceptions, "Either the constructor must be noexcept (to prevent being in an invalid state) or AllowExceptions in the few places where an invalid state is fine. But not both because that's a logical error.");
         ::new (static_cast<void*>(::std::addressof(viewing)), constexpr_new_tag{0}) string_view_type(static_cast<Args&&>(args)...);
         tag = VIEWING;
+        // Callers that know the new view is null terminated set this afterwards
+        view_null_terminated = false;
     }
 
     union {
         string_view_type viewing;
         string_type owning;
     };
-    // previous union should be aligned on pointer, which should be the same align as size_t
     // (Not using enum to prevent warnings about the `default: unreachable()` branch on every switch)
-    using tag_t = size_type;
+    // A byte, so that the tag and view_null_terminated fit in the padding after the pointer aligned union
+    using tag_t = unsigned char;
     tag_t tag;
+    // Only meaningful when viewing: whether viewing.data()[viewing.size()] is known to be a null character
+    bool view_null_terminated = false;
     static constexpr tag_t OWNING = static_cast<tag_t>(1);
     static constexpr tag_t VIEWING = static_cast<tag_t>(0);
 };
 
+template<typename CharT, typename Traits, typename Allocator>
+struct is_trivially_relocatable<basic_string_or_view<CharT, Traits, Allocator>> : is_trivially_relocatable<std::basic_string<CharT, Traits, Allocator>> {};
+
 template<typename StringOrView, typename Allocator = void>
 struct to_string_or_view;
 
@@ -0,0 +1,799 @@
+#ifndef STRING_OR_VIEW_ART_H
+#define STRING_OR_VIEW_ART_H
+
+// art_map: an ordered map from basic_string_or_view keys, stored in an adaptive radix tree
+// (Leis, Kemper, Neumann: "The Adaptive Radix Tree: ARTful Indexing for Main-Memory Databases").
+//
+//     art_map<string_or_view, int> m;
+//     m.try_emplace("literal", 1);  // Viewing key: the caller guarantees the literal outlives the map
+//     m.try_emplace(std::string(runtime), 2);  // Owning key
+//     m.find(std::string_view("literal"));  // Lookup by view, no key constructed
+//     for (auto& [k, v] : m.prefix_range("/api/")) {}  // Every key starting with "/api/", in order
+//
+// Inner nodes hold 4, 16, 48 or 256 children (growing and shrinking as needed) and up to 8 bytes of compressed path inline
+// (longer paths are checked against a key in the subtree). A lookup touches one node per distinct byte instead of doing a
+// full key comparison per level, and leaves are linked in key order, so iteration and range scans don't walk the tree.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "string_or_view.h"
+#include "string_or_view_simd.h"
+
+template<typename Key, typename T>
+class art_map {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const key_type, mapped_type>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using string_view_type = typename key_type::string_view_type;
+
+    static_assert(sizeof(typename key_type::char_type) == 1 && std::is_same<typename key_type::traits_type, std::char_traits<typename key_type::char_type>>::value,
+        "art_map orders keys by their bytes, so it needs byte sized code units with std::char_traits to have the same order as Key's operator<");
+
+private:
+    struct leaf {
+        value_type value;
+        leaf* prev = nullptr;
+        leaf* next = nullptr;
+
+        template<typename K, typename... Args>
+        explicit leaf(K&& key, Args&&... args)
+            : value(std::piecewise_construct, std::forward_as_tuple(static_cast<K&&>(key)), std::forward_as_tuple(static_cast<Args&&>(args)...)) {}
+
+        [[nodiscard]] string_view_type key() const noexcept { return *value.first; }
+    };
+
+public:
+    template<bool Const>
+    class iterator_base {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename art_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+        constexpr iterator_base() noexcept : current(nullptr), map(nullptr) {}
+        // iterator -> const_iterator
+        template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        constexpr iterator_base(const iterator_base<OtherConst>& other) noexcept : current(other.current), map(other.map) {}
+
+        [[nodiscard]] reference operator*() const noexcept { return current->value; }
+        [[nodiscard]] pointer operator->() const noexcept { return std::addressof(current->value); }
+
+        iterator_base& operator++() noexcept { current = current->next; return *this; }
+        iterator_base operator++(int) noexcept { iterator_base copy = *this; ++*this; return copy; }
+        iterator_base& operator--() noexcept { current = current ? current->prev : map->tail; return *this; }
+        iterator_base operator--(int) noexcept { iterator_base copy = *this; --*this; return copy; }
+
+        [[nodiscard]] friend bool operator==(const iterator_base& l, const iterator_base& r) noexcept { return l.current == r.current; }
+        [[nodiscard]] friend bool operator!=(const iterator_base& l, const iterator_base& r) noexcept { return l.current != r.current; }
+
+    private:
+        friend class art_map;
+        template<bool> friend class iterator_base;
+
+        constexpr iterator_base(leaf* current, const art_map* map) noexcept : current(current), map(map) {}
+
+        leaf* current;  // nullptr for end()
+        const art_map* map;
+    };
+
+    using iterator = iterator_base<false>;
+    using const_iterator = iterator_base<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // [begin(), end()) with begin() and end() members, for range-for over the results of prefix_range and range
+    template<typename It>
+    struct subrange {
+        It first;
+        It last;
+        [[nodiscard]] It begin() const noexcept { return first; }
+        [[nodiscard]] It end() const noexcept { return last; }
+        [[nodiscard]] bool empty() const noexcept { return first == last; }
+    };
+
+    art_map() noexcept = default;
+    art_map(const art_map& other) : art_map() {
+        for (const value_type& v : other) try_emplace(v.first, v.second);
+    }
+    art_map(art_map&& other) noexcept : root(std::exchange(other.root, node_ptr())), head(std::exchange(other.head, nullptr)), tail(std::exchange(other.tail, nullptr)), element_count(std::exchange(other.element_count, 0)) {}
+    art_map& operator=(const art_map& other) {
+        if (this != std::addressof(other)) {
+            art_map copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+    art_map& operator=(art_map&& other) noexcept {
+        art_map moved(static_cast<art_map&&>(other));
+        swap(moved);
+        return *this;
+    }
+    ~art_map() { clear(); }
+
+    void swap(art_map& other) noexcept {
+        std::swap(root, other.root);
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(element_count, other.element_count);
+    }
+    friend void swap(art_map& l, art_map& r) noexcept { l.swap(r); }
+
+    [[nodiscard]] iterator begin() noexcept { return iterator(head, this); }
+    [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(head, this); }
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+    [[nodiscard]] iterator end() noexcept { return iterator(nullptr, this); }
+    [[nodiscard]] const_iterator end() const noexcept { return const_iterator(nullptr, this); }
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+    [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    [[nodiscard]] bool empty() const noexcept { return element_count == 0; }
+    [[nodiscard]] size_type size() const noexcept { return element_count; }
+
+    void clear() noexcept {
+        destroy_nodes(root);
+        root = node_ptr();
+        for (leaf* l = head; l;) delete std::exchange(l, l->next);
+        head = tail = nullptr;
+        element_count = 0;
+    }
+
+    // Inserts {key, mapped_type(args...)} if no equal key exists. The key is stored as given (viewing or owning)
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) { return emplace_impl(key, static_cast<Args&&>(args)...); }
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) { return emplace_impl(static_cast<key_type&&>(key), static_cast<Args&&>(args)...); }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return emplace_impl(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type&& value) { return emplace_impl(value.first, static_cast<mapped_type&&>(value.second)); }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(key_type key, M&& obj) {
+        std::pair<iterator, bool> result = emplace_impl(static_cast<key_type&&>(key), static_cast<M&&>(obj));
+        if (!result.second) result.first->second = static_cast<M&&>(obj);
+        return result;
+    }
+
+    mapped_type& operator[](key_type key) { return emplace_impl(static_cast<key_type&&>(key)).first->second; }
+
+    [[nodiscard]] iterator find(string_view_type key) noexcept { return iterator(find_leaf(key), this); }
+    [[nodiscard]] const_iterator find(string_view_type key) const noexcept { return const_iterator(find_leaf(key), this); }
+    [[nodiscard]] bool contains(string_view_type key) const noexcept { return find_leaf(key) != nullptr; }
+    [[nodiscard]] size_type count(string_view_type key) const noexcept { return contains(key) ? 1 : 0; }
+
+    mapped_type& at(string_view_type key) {
+        leaf* l = find_leaf(key);
+        if (!l) throw std::out_of_range("art_map::at");
+        return l->value.second;
+    }
+    const mapped_type& at(string_view_type key) const {
+        leaf* l = find_leaf(key);
+        if (!l) throw std::out_of_range("art_map::at");
+        return l->value.second;
+    }
+
+    // First element with a key not less than `key`
+    [[nodiscard]] iterator lower_bound(string_view_type key) noexcept { return iterator(lower_bound_leaf(key), this); }
+    [[nodiscard]] const_iterator lower_bound(string_view_type key) const noexcept { return const_iterator(lower_bound_leaf(key), this); }
+    // First element with a key greater than `key`
+    [[nodiscard]] iterator upper_bound(string_view_type key) noexcept { return iterator(upper_bound_leaf(key), this); }
+    [[nodiscard]] const_iterator upper_bound(string_view_type key) const noexcept { return const_iterator(upper_bound_leaf(key), this); }
+
+    // Every element whose key starts with `prefix`, in order
+    [[nodiscard]] subrange<iterator> prefix_range(string_view_type prefix) noexcept {
+        std::pair<leaf*, leaf*> r = prefix_leaves(prefix);
+        return { iterator(r.first, this), iterator(r.second, this) };
+    }
+    [[nodiscard]] subrange<const_iterator> prefix_range(string_view_type prefix) const noexcept {
+        std::pair<leaf*, leaf*> r = prefix_leaves(prefix);
+        return { const_iterator(r.first, this), const_iterator(r.second, this) };
+    }
+
+    // Every element with lo <= key < hi, in order
+    [[nodiscard]] subrange<iterator> range(string_view_type lo, string_view_type hi) noexcept {
+        return { lower_bound(lo), lo < hi ? lower_bound(hi) : lower_bound(lo) };
+    }
+    [[nodiscard]] subrange<const_iterator> range(string_view_type lo, string_view_type hi) const noexcept {
+        return { lower_bound(lo), lo < hi ? lower_bound(hi) : lower_bound(lo) };
+    }
+
+    iterator erase(const_iterator pos) noexcept {
+        leaf* next = pos.current->next;
+        erase_leaf(pos.current);
+        return iterator(next, this);
+    }
+    iterator erase(iterator pos) noexcept { return erase(const_iterator(pos)); }
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        while (first != last) first = erase(first);
+        return iterator(last.current, this);
+    }
+    size_type erase(string_view_type key) noexcept {
+        leaf* l = find_leaf(key);
+        if (!l) return 0;
+        erase_leaf(l);
+        return 1;
+    }
+
+private:
+    static constexpr std::size_t max_stored_prefix = 8;
+
+    enum node_type : unsigned char { NODE4, NODE16, NODE48, NODE256 };
+
+    struct node {
+        node_type type;
+        std::uint16_t children = 0;
+        std::uint32_t prefix_len = 0;  // Length of the compressed path, of which up to `max_stored_prefix` bytes are in `prefix`
+        unsigned char prefix[max_stored_prefix] = {};
+        leaf* terminal = nullptr;  // The key that ends exactly at this node (after the prefix), if any
+
+        explicit node(node_type type) noexcept : type(type) {}
+    };
+
+    // A tagged pointer to either a node or a leaf (low bit set)
+    struct node_ptr {
+        std::uintptr_t bits = 0;
+
+        node_ptr() noexcept = default;
+        node_ptr(node* n) noexcept : bits(reinterpret_cast<std::uintptr_t>(n)) {}
+        node_ptr(leaf* l) noexcept : bits(reinterpret_cast<std::uintptr_t>(l) | 1u) {}
+
+        [[nodiscard]] explicit operator bool() const noexcept { return bits != 0; }
+        [[nodiscard]] bool is_leaf() const noexcept { return bits & 1u; }
+        [[nodiscard]] leaf* as_leaf() const noexcept { return reinterpret_cast<leaf*>(bits & ~static_cast<std::uintptr_t>(1u)); }
+        [[nodiscard]] node* as_node() const noexcept { return reinterpret_cast<node*>(bits); }
+    };
+
+    // Keys are sorted
+    struct node4 : node {
+        unsigned char keys[4] = {};
+        node_ptr child[4];
+        node4() noexcept : node(NODE4) {}
+    };
+    struct node16 : node {
+        unsigned char keys[16] = {};
+        node_ptr child[16];
+        node16() noexcept : node(NODE16) {}
+    };
+    // index[byte] is 1 + the slot in `child`, or 0 if there is no child for that byte
+    struct node48 : node {
+        unsigned char index[256] = {};
+        node_ptr child[48];
+        node48() noexcept : node(NODE48) {}
+    };
+    struct node256 : node {
+        node_ptr child[256];
+        node256() noexcept : node(NODE256) {}
+    };
+
+    [[nodiscard]] static unsigned char byte_at(string_view_type s, std::size_t i) noexcept { return static_cast<unsigned char>(s[i]); }
+
+    static void delete_node(node* n) noexcept {
+        switch (n->type) {
+        case NODE4: delete static_cast<node4*>(n); break;
+        case NODE16: delete static_cast<node16*>(n); break;
+        case NODE48: delete static_cast<node48*>(n); break;
+        case NODE256: delete static_cast<node256*>(n); break;
+        }
+    }
+
+    // Deletes inner nodes only (leaves are owned by the linked list)
+    static void destroy_nodes(node_ptr p) noexcept {
+        if (!p || p.is_leaf()) return;
+        node* n = p.as_node();
+        for_each_child(n, [](unsigned char, node_ptr c) noexcept { destroy_nodes(c); });
+        delete_node(n);
+    }
+
+    [[nodiscard]] static node_ptr* find_child(node* n, unsigned char b) noexcept {
+        switch (n->type) {
+        case NODE4: {
+            node4* n4 = static_cast<node4*>(n);
+            for (std::size_t i = 0; i != n->children; ++i) {
+                if (n4->keys[i] == b) return &n4->child[i];
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            node16* n16 = static_cast<node16*>(n);
+#ifdef STRING_OR_VIEW_SIMD_SSE2
+            std::uint32_t m = string_or_view_detail::sse2_batch::load(n16->keys).eq(b).mask() & ((std::uint32_t{1} << n->children) - 1u);
+            return m ? &n16->child[string_or_view_detail::count_trailing_zeros(m)] : nullptr;
+#else
+            for (std::size_t i = 0; i != n->children; ++i) {
+                if (n16->keys[i] == b) return &n16->child[i];
+            }
+            return nullptr;
+#endif
+        }
+        case NODE48: {
+            node48* n48 = static_cast<node48*>(n);
+            return n48->index[b] ? &n48->child[n48->index[b] - 1] : nullptr;
+        }
+        case NODE256: {
+            node256* n256 = static_cast<node256*>(n);
+            return n256->child[b] ? &n256->child[b] : nullptr;
+        }
+        }
+        return nullptr;
+    }
+
+    // The child with the smallest byte >= b (b can be 256 for none)
+    [[nodiscard]] static node_ptr first_child_from(node* n, unsigned b) noexcept {
+        switch (n->type) {
+        case NODE4:
+        case NODE16: {
+            const unsigned char* keys = n->type == NODE4 ? static_cast<node4*>(n)->keys : static_cast<node16*>(n)->keys;
+            const node_ptr* child = n->type == NODE4 ? static_cast<node4*>(n)->child : static_cast<node16*>(n)->child;
+            for (std::size_t i = 0; i != n->children; ++i) {
+                if (keys[i] >= b) return child[i];
+            }
+            return node_ptr();
+        }
+        case NODE48: {
+            node48* n48 = static_cast<node48*>(n);
+            for (; b < 256; ++b) {
+                if (n48->index[b]) return n48->child[n48->index[b] - 1];
+            }
+            return node_ptr();
+        }
+        case NODE256: {
+            node256* n256 = static_cast<node256*>(n);
+            for (; b < 256; ++b) {
+                if (n256->child[b]) return n256->child[b];
+            }
+            return node_ptr();
+        }
+        }
+        return node_ptr();
+    }
+
+    // f(byte, child) for each child in byte order
+    template<typename F>
+    static void for_each_child(node* n, F f) {
+        switch (n->type) {
+        case NODE4:
+            for (std::size_t i = 0; i != n->children; ++i) f(static_cast<node4*>(n)->keys[i], static_cast<node4*>(n)->child[i]);
+            break;
+        case NODE16:
+            for (std::size_t i = 0; i != n->children; ++i) f(static_cast<node16*>(n)->keys[i], static_cast<node16*>(n)->child[i]);
+            break;
+        case NODE48: {
+            node48* n48 = static_cast<node48*>(n);
+            for (unsigned b = 0; b != 256; ++b) {
+                if (n48->index[b]) f(static_cast<unsigned char>(b), n48->child[n48->index[b] - 1]);
+            }
+            break;
+        }
+        case NODE256: {
+            node256* n256 = static_cast<node256*>(n);
+            for (unsigned b = 0; b != 256; ++b) {
+                if (n256->child[b]) f(static_cast<unsigned char>(b), n256->child[b]);
+            }
+            break;
+        }
+        }
+    }
+
+    [[nodiscard]] static node_ptr last_child(node* n) noexcept {
+        switch (n->type) {
+        case NODE4: return n->children ? static_cast<node4*>(n)->child[n->children - 1] : node_ptr();
+        case NODE16: return n->children ? static_cast<node16*>(n)->child[n->children - 1] : node_ptr();
+        case NODE48: {
+            node48* n48 = static_cast<node48*>(n);
+            for (unsigned b = 256; b-- != 0;) {
+                if (n48->index[b]) return n48->child[n48->index[b] - 1];
+            }
+            return node_ptr();
+        }
+        case NODE256: {
+            node256* n256 = static_cast<node256*>(n);
+            for (unsigned b = 256; b-- != 0;) {
+                if (n256->child[b]) return n256->child[b];
+            }
+            return node_ptr();
+        }
+        }
+        return node_ptr();
+    }
+
+    [[nodiscard]] static leaf* min_leaf(node_ptr p) noexcept {
+        while (!p.is_leaf()) {
+            node* n = p.as_node();
+            if (n->terminal) return n->terminal;
+            p = first_child_from(n, 0);
+        }
+        return p.as_leaf();
+    }
+
+    [[nodiscard]] static leaf* max_leaf(node_ptr p) noexcept {
+        while (!p.is_leaf()) {
+            node* n = p.as_node();
+            node_ptr c = last_child(n);
+            if (!c) return n->terminal;
+            p = c;
+        }
+        return p.as_leaf();
+    }
+
+    // Byte i of the compressed path of n, which starts at `depth` in the keys below it
+    [[nodiscard]] static unsigned char prefix_byte(node* n, std::size_t depth, std::size_t i) noexcept {
+        if (i < max_stored_prefix) return n->prefix[i];
+        return byte_at(min_leaf(n)->key(), depth + i);
+    }
+
+    // Index of the first byte of n's compressed path that doesn't match key (or where key ends), or prefix_len if all match
+    [[nodiscard]] static std::size_t prefix_mismatch(node* n, string_view_type key, std::size_t depth) noexcept {
+        std::size_t len = n->prefix_len;
+        std::size_t available = key.size() - depth;
+        std::size_t stored = len < max_stored_prefix ? len : max_stored_prefix;
+        std::size_t i = 0;
+        for (; i != stored; ++i) {
+            if (i == available || n->prefix[i] != byte_at(key, depth + i)) return i;
+        }
+        if (len > max_stored_prefix) {
+            string_view_type full = min_leaf(n)->key();
+            for (; i != len; ++i) {
+                if (i == available || full[depth + i] != key[depth + i]) return i;
+            }
+        }
+        return len;
+    }
+
+    static void set_prefix(node* n, string_view_type source, std::size_t from, std::size_t len) noexcept {
+        n->prefix_len = static_cast<std::uint32_t>(len);
+        std::size_t stored = len < max_stored_prefix ? len : max_stored_prefix;
+        for (std::size_t i = 0; i != stored; ++i) n->prefix[i] = byte_at(source, from + i);
+    }
+
+    // Add a child to a node with room for it
+    template<typename Sorted>
+    static void add_sorted(Sorted* n, unsigned char b, node_ptr c) noexcept {
+        std::size_t i = n->children;
+        for (; i != 0 && n->keys[i - 1] > b; --i) {
+            n->keys[i] = n->keys[i - 1];
+            n->child[i] = n->child[i - 1];
+        }
+        n->keys[i] = b;
+        n->child[i] = c;
+        ++n->children;
+    }
+    static void add_to(node4* n, unsigned char b, node_ptr c) noexcept { add_sorted(n, b, c); }
+    static void add_to(node16* n, unsigned char b, node_ptr c) noexcept { add_sorted(n, b, c); }
+    static void add_to(node48* n, unsigned char b, node_ptr c) noexcept {
+        std::size_t slot = 0;
+        while (n->child[slot]) ++slot;
+        n->child[slot] = c;
+        n->index[b] = static_cast<unsigned char>(slot + 1);
+        ++n->children;
+    }
+    static void add_to(node256* n, unsigned char b, node_ptr c) noexcept {
+        n->child[b] = c;
+        ++n->children;
+    }
+
+    // Replace *ref with `to` (a new, empty node of another type), moving the path, terminal and children into it
+    template<typename To>
+    static void change_node_type(node_ptr* ref, To* to) noexcept {
+        node* n = ref->as_node();
+        to->prefix_len = n->prefix_len;
+        std::memcpy(to->prefix, n->prefix, max_stored_prefix);
+        to->terminal = n->terminal;
+        for_each_child(n, [to](unsigned char b, node_ptr c) noexcept { add_to(to, b, c); });
+        delete_node(n);
+        *ref = to;
+    }
+
+    // Shrinking only saves memory, so (since erase is noexcept) it is skipped if the smaller node can't be allocated.
+    // A node with fewer children than its type needs still works, and is shrunk by a later erase
+    template<typename To>
+    static void try_shrink(node_ptr* ref) noexcept {
+        if (To* to = new (std::nothrow) To()) change_node_type(ref, to);
+    }
+
+    // Replace *ref with the next smaller node type if it has few enough children
+    static void maybe_shrink(node_ptr* ref) noexcept {
+        node* n = ref->as_node();
+        switch (n->type) {
+        case NODE16: if (n->children <= 3) try_shrink<node4>(ref); break;
+        case NODE48: if (n->children <= 12) try_shrink<node16>(ref); break;
+        case NODE256: if (n->children <= 37) try_shrink<node48>(ref); break;
+        default: break;
+        }
+    }
+
+    static void add_child(node_ptr* ref, unsigned char b, node_ptr c) {
+        node* n = ref->as_node();
+        switch (n->type) {
+        case NODE4:
+            if (n->children != 4) return add_to(static_cast<node4*>(n), b, c);
+            change_node_type(ref, new node16());
+            return add_to(static_cast<node16*>(ref->as_node()), b, c);
+        case NODE16:
+            if (n->children != 16) return add_to(static_cast<node16*>(n), b, c);
+            change_node_type(ref, new node48());
+            return add_to(static_cast<node48*>(ref->as_node()), b, c);
+        case NODE48:
+            if (n->children != 48) return add_to(static_cast<node48*>(n), b, c);
+            change_node_type(ref, new node256());
+            return add_to(static_cast<node256*>(ref->as_node()), b, c);
+        case NODE256:
+            return add_to(static_cast<node256*>(n), b, c);
+        }
+    }
+
+    static void remove_child(node* n, unsigned char b) noexcept {
+        switch (n->type) {
+        case NODE4:
+        case NODE16: {
+            unsigned char* keys = n->type == NODE4 ? static_cast<node4*>(n)->keys : static_cast<node16*>(n)->keys;
+            node_ptr* child = n->type == NODE4 ? static_cast<node4*>(n)->child : static_cast<node16*>(n)->child;
+            std::size_t i = 0;
+            while (keys[i] != b) ++i;
+            for (; i + 1 < n->children; ++i) {
+                keys[i] = keys[i + 1];
+                child[i] = child[i + 1];
+            }
+            break;
+        }
+        case NODE48: {
+            node48* n48 = static_cast<node48*>(n);
+            n48->child[n48->index[b] - 1] = node_ptr();
+            n48->index[b] = 0;
+            break;
+        }
+        case NODE256:
+            static_cast<node256*>(n)->child[b] = node_ptr();
+            break;
+        }
+        --n->children;
+    }
+
+    [[nodiscard]] leaf* find_leaf(string_view_type key) const noexcept {
+        node_ptr p = root;
+        std::size_t depth = 0;
+        while (p) {
+            if (p.is_leaf()) {
+                leaf* l = p.as_leaf();
+                return l->key() == key ? l : nullptr;
+            }
+            node* n = p.as_node();
+            // Only the stored bytes are checked on the way down. The final comparison with the leaf catches the rest
+            std::size_t stored = n->prefix_len < max_stored_prefix ? n->prefix_len : max_stored_prefix;
+            if (key.size() - depth < n->prefix_len) return nullptr;
+            for (std::size_t i = 0; i != stored; ++i) {
+                if (n->prefix[i] != byte_at(key, depth + i)) return nullptr;
+            }
+            depth += n->prefix_len;
+            if (depth == key.size()) {
+                leaf* l = n->terminal;
+                return l && l->key() == key ? l : nullptr;
+            }
+            node_ptr* c = find_child(n, byte_at(key, depth));
+            if (!c) return nullptr;
+            p = *c;
+            ++depth;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] leaf* lower_bound_leaf(string_view_type key) const noexcept {
+        node_ptr p = root;
+        std::size_t depth = 0;
+        if (!p) return nullptr;
+        while (true) {
+            if (p.is_leaf()) {
+                leaf* l = p.as_leaf();
+                return l->key() >= key ? l : l->next;
+            }
+            node* n = p.as_node();
+            std::size_t mismatch = prefix_mismatch(n, key, depth);
+            if (mismatch != n->prefix_len) {
+                // Either key ended inside the path, or the path differs: the whole subtree is either after or before key
+                if (depth + mismatch == key.size() || byte_at(key, depth + mismatch) < prefix_byte(n, depth, mismatch)) return min_leaf(n);
+                return max_leaf(n)->next;
+            }
+            depth += n->prefix_len;
+            if (depth == key.size()) return min_leaf(n);
+            unsigned char b = byte_at(key, depth);
+            node_ptr* c = find_child(n, b);
+            if (c) {
+                p = *c;
+                ++depth;
+                continue;
+            }
+            node_ptr after = first_child_from(n, b + 1u);
+            return after ? min_leaf(after) : max_leaf(n)->next;
+        }
+    }
+
+    [[nodiscard]] leaf* upper_bound_leaf(string_view_type key) const noexcept {
+        leaf* l = lower_bound_leaf(key);
+        return l && l->key() == key ? l->next : l;
+    }
+
+    [[nodiscard]] std::pair<leaf*, leaf*> prefix_leaves(string_view_type prefix) const noexcept {
+        node_ptr p = root;
+        std::size_t depth = 0;
+        while (p) {
+            if (p.is_leaf()) break;
+            node* n = p.as_node();
+            std::size_t mismatch = prefix_mismatch(n, prefix, depth);
+            if (depth + mismatch == prefix.size()) break;  // Every key below n starts with prefix
+            if (mismatch != n->prefix_len) return { nullptr, nullptr };
+            depth += n->prefix_len;
+            node_ptr* c = find_child(n, byte_at(prefix, depth));
+            if (!c) return { nullptr, nullptr };
+            p = *c;
+            ++depth;
+        }
+        if (!p) return { nullptr, nullptr };
+        if (p.is_leaf() && p.as_leaf()->key().substr(0, prefix.size()) != prefix) return { nullptr, nullptr };
+        return { min_leaf(p), max_leaf(p)->next };
+    }
+
+    // Put l into a new node m (whose path ends at `depth`) as either the terminal or a child
+    static void place_in_new_node(node4* m, leaf* l, std::size_t depth) noexcept {
+        string_view_type key = l->key();
+        if (key.size() == depth) m->terminal = l;
+        else add_to(m, byte_at(key, depth), l);
+    }
+
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> emplace_impl(K&& key, Args&&... args) {
+        leaf* successor = lower_bound_leaf(*key);
+        if (successor && successor->key() == *key) return { iterator(successor, this), false };
+
+        leaf* l = new leaf(static_cast<K&&>(key), static_cast<Args&&>(args)...);
+        try {
+            insert_leaf(l);
+        } catch (...) {
+            delete l;
+            throw;
+        }
+
+        // Link into the ordered list before its successor
+        l->next = successor;
+        l->prev = successor ? successor->prev : tail;
+        (l->prev ? l->prev->next : head) = l;
+        (successor ? successor->prev : tail) = l;
+        ++element_count;
+        return { iterator(l, this), true };
+    }
+
+    // Insert a leaf whose key is not in the tree
+    void insert_leaf(leaf* l) {
+        // Use the key stored in the leaf, which has a stable address
+        string_view_type key = l->key();
+        node_ptr* ref = &root;
+        std::size_t depth = 0;
+        while (true) {
+            if (!*ref) {
+                *ref = l;
+                return;
+            }
+            if (ref->is_leaf()) {
+                leaf* existing = ref->as_leaf();
+                string_view_type existing_key = existing->key();
+                std::size_t common = depth;
+                while (common != key.size() && common != existing_key.size() && key[common] == existing_key[common]) ++common;
+                node4* m = new node4();
+                set_prefix(m, key, depth, common - depth);
+                place_in_new_node(m, existing, common);
+                place_in_new_node(m, l, common);
+                *ref = m;
+                return;
+            }
+            node* n = ref->as_node();
+            std::size_t mismatch = prefix_mismatch(n, key, depth);
+            if (mismatch != n->prefix_len) {
+                // Split the compressed path: m takes the matching part, n keeps what is after the mismatching byte
+                node4* m = new node4();
+                set_prefix(m, key, depth, mismatch);
+                unsigned char n_byte = prefix_byte(n, depth, mismatch);
+                std::size_t cut = mismatch + 1;
+                std::size_t new_len = n->prefix_len - cut;
+                if (n->prefix_len <= max_stored_prefix) {
+                    std::memmove(n->prefix, n->prefix + cut, new_len);
+                    n->prefix_len = static_cast<std::uint32_t>(new_len);
+                } else {
+                    set_prefix(n, min_leaf(n)->key(), depth + cut, new_len);
+                }
+                add_to(m, n_byte, n);
+                place_in_new_node(m, l, depth + mismatch);
+                *ref = m;
+                return;
+            }
+            depth += n->prefix_len;
+            if (depth == key.size()) {
+                n->terminal = l;
+                return;
+            }
+            node_ptr* c = find_child(n, byte_at(key, depth));
+            if (!c) {
+                add_child(ref, byte_at(key, depth), l);
+                return;
+            }
+            ref = c;
+            ++depth;
+        }
+    }
+
+    void erase_leaf(leaf* l) noexcept {
+        string_view_type key = l->key();
+        node_ptr* ref = &root;
+        node_ptr* parent = nullptr;  // The node holding l (nullptr if l is the root)
+        std::size_t parent_depth = 0;
+        std::size_t depth = 0;
+        while (!ref->is_leaf()) {
+            node* n = ref->as_node();
+            parent = ref;
+            parent_depth = depth;
+            depth += n->prefix_len;
+            if (depth == key.size()) break;  // l is the terminal
+            ref = find_child(n, byte_at(key, depth));
+            ++depth;
+        }
+
+        if (!parent) {
+            root = node_ptr();
+        } else {
+            node* n = parent->as_node();
+            if (n->terminal == l) n->terminal = nullptr;
+            else {
+                remove_child(n, byte_at(key, parent_depth + n->prefix_len));
+                maybe_shrink(parent);
+            }
+            collapse(parent, parent_depth);
+        }
+
+        (l->prev ? l->prev->next : head) = l->next;
+        (l->next ? l->next->prev : tail) = l->prev;
+        delete l;
+        --element_count;
+    }
+
+    // Restore path compression after a removal from *ref: a node with only a terminal becomes that leaf,
+    // and a node with only one child is merged into it
+    static void collapse(node_ptr* ref, std::size_t depth) noexcept {
+        node* n = ref->as_node();
+        if (n->children == 0) {
+            *ref = n->terminal;
+            delete_node(n);
+        } else if (n->children == 1 && !n->terminal) {
+            node_ptr c = first_child_from(n, 0);
+            if (!c.is_leaf()) {
+                node* cn = c.as_node();
+                std::size_t len = n->prefix_len + 1 + cn->prefix_len;
+                set_prefix(cn, min_leaf(cn)->key(), depth, len);
+            }
+            *ref = c;
+            delete_node(n);
+        }
+    }
+
+    node_ptr root;
+    leaf* head = nullptr;  // Smallest key
+    leaf* tail = nullptr;  // Largest key
+    size_type element_count = 0;
+};
+
+#endif  // STRING_OR_VIEW_ART_H
@@ -0,0 +1,173 @@
+#ifndef STRING_OR_VIEW_CI_H
+#define STRING_OR_VIEW_CI_H
+
+// ASCII case-insensitive char traits, and a hash that agrees with them.
+//
+//     std::unordered_map<ci_string_or_view, int> headers;  // std::hash<ci_string_or_view> is the case-insensitive hash
+//     headers["Content-Length"] = 1;
+//     headers.count("content-length");  // 1
+//     string_or_view::replace_traits<ascii_ci_char_traits> s = "Host";  // Same as ci_string_or_view
+//
+// Only 'A'-'Z' and 'a'-'z' compare equal to each other. Every other byte (including non-ASCII bytes) is compared as an unsigned char,
+// and strings order as if every uppercase ASCII letter were lowercase. compare and find check 16 or 32 bytes at a time with SSE2 or AVX2
+// when available (see string_or_view_simd.h), and 8 at a time with integer operations for the rest. The hash is SWAR only (no SIMD):
+// it folds 8 bytes at a time with those integer operations and otherwise is string_or_view_hash, so the hash of a string with no
+// uppercase letters is the same for both.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "string_or_view.h"
+#include "string_or_view_simd.h"
+#include "string_or_view_hash.h"
+
+namespace string_or_view_detail {
+
+    [[nodiscard]] constexpr unsigned char ascii_fold(unsigned char c) noexcept {
+        return static_cast<unsigned char>(c - 'A') < 26u ? static_cast<unsigned char>(c | 0x20u) : c;
+    }
+
+    // ascii_fold on each byte of v
+    [[nodiscard]] inline std::uint64_t ascii_fold_u64(std::uint64_t v) noexcept {
+        constexpr std::uint64_t low7 = 0x7F7F7F7F7F7F7F7Fu;
+        constexpr std::uint64_t high = 0x8080808080808080u;
+        std::uint64_t heptets = v & low7;
+        // Top bit of each byte: heptet >= 'A', and heptet > 'Z' (the additions can't carry into the next byte)
+        std::uint64_t at_least_a = heptets + 0x3F3F3F3F3F3F3F3Fu;
+        std::uint64_t above_z = heptets + 0x2525252525252525u;
+        std::uint64_t upper = at_least_a & ~above_z & ~v & high;
+        return v | (upper >> 2);
+    }
+
+#if defined(STRING_OR_VIEW_SIMD_SSE2) || defined(STRING_OR_VIEW_SIMD_AVX2)
+    template<typename Batch>
+    [[nodiscard]] Batch ascii_fold(Batch b) noexcept { return b | (b.in_range('A', 'Z') & Batch::splat(0x20)); }
+
+    // Compares [a, a + n) and [b, b + n) `Batch::width` bytes at a time from `i`. Returns the index of the first folded
+    // difference, or sets `i` to where the remaining (less than a whole batch) bytes start and returns n
+    template<typename Batch>
+    [[nodiscard]] std::size_t ascii_ci_mismatch(const unsigned char* a, const unsigned char* b, std::size_t n, std::size_t& i) noexcept {
+        constexpr std::uint32_t all = Batch::width == 32 ? 0xFFFFFFFFu : (1u << Batch::width) - 1u;
+        for (; i + Batch::width <= n; i += Batch::width) {
+            std::uint32_t m = ascii_fold(Batch::load(a + i)).eq(ascii_fold(Batch::load(b + i))).mask() ^ all;
+            if (m != 0u) return i + count_trailing_zeros(m);
+        }
+        return n;
+    }
+#endif
+
+    [[nodiscard]] inline int ascii_ci_compare(const unsigned char* a, const unsigned char* b, std::size_t n) noexcept {
+        std::size_t i = 0;
+        std::size_t mismatch = n;
+#ifdef STRING_OR_VIEW_SIMD_AVX2
+        mismatch = ascii_ci_mismatch<avx2_batch>(a, b, n, i);
+#endif
+#ifdef STRING_OR_VIEW_SIMD_SSE2
+        if (mismatch == n) mismatch = ascii_ci_mismatch<sse2_batch>(a, b, n, i);
+#endif
+        if (mismatch != n) {
+            unsigned char l = ascii_fold(a[mismatch]);
+            unsigned char r = ascii_fold(b[mismatch]);
+            return l < r ? -1 : 1;
+        }
+        // Skip equal words, then find the difference (if any) in the last few bytes one at a time
+        for (; i + 8 <= n; i += 8) {
+            if (ascii_fold_u64(load_u64(a + i)) != ascii_fold_u64(load_u64(b + i))) break;
+        }
+        for (; i != n; ++i) {
+            unsigned char l = ascii_fold(a[i]);
+            unsigned char r = ascii_fold(b[i]);
+            if (l != r) return l < r ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // Either of two bytes (the two cases of a letter)
+    struct byte_eq_either_pred {
+        unsigned char c0;
+        unsigned char c1;
+        [[nodiscard]] std::size_t lookahead() const noexcept { return 0; }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char*) const noexcept { return *p == c0 || *p == c1; }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept { Batch b = Batch::load(p); return b.eq(c0) | b.eq(c1); }
+    };
+
+    // string_or_view_detail::hash_bytes, with every word folded before it is mixed in
+    [[nodiscard]] inline std::uint64_t ascii_ci_hash_bytes(const unsigned char* p, std::size_t n) noexcept {
+        std::uint64_t h = hash_seed(n);
+        std::size_t blocks = n / 8;
+        for (std::size_t b = 0; b != blocks; ++b) h = hash_step(h, ascii_fold_u64(load_u64(p + 8 * b)));
+        std::size_t r = n % 8;
+        // load_tail only moves whole bytes around (and fills with zeros), so folding afterwards is the same as folding first
+        if (r != 0) h = hash_step(h, ascii_fold_u64(load_tail(p + n, r, n >= 8)));
+        return hash_mix(h);
+    }
+
+}  // namespace string_or_view_detail
+
+// std::char_traits<char> where 'A'-'Z' are equal to 'a'-'z'
+struct ascii_ci_char_traits : std::char_traits<char> {
+    [[nodiscard]] static constexpr bool eq(char_type l, char_type r) noexcept {
+        return string_or_view_detail::ascii_fold(static_cast<unsigned char>(l)) == string_or_view_detail::ascii_fold(static_cast<unsigned char>(r));
+    }
+    [[nodiscard]] static constexpr bool lt(char_type l, char_type r) noexcept {
+        return string_or_view_detail::ascii_fold(static_cast<unsigned char>(l)) < string_or_view_detail::ascii_fold(static_cast<unsigned char>(r));
+    }
+
+    [[nodiscard]] static int compare(const char_type* l, const char_type* r, std::size_t n) noexcept {
+        return string_or_view_detail::ascii_ci_compare(reinterpret_cast<const unsigned char*>(l), reinterpret_cast<const unsigned char*>(r), n);
+    }
+
+    [[nodiscard]] static const char_type* find(const char_type* p, std::size_t n, const char_type& c) noexcept {
+        unsigned char folded = string_or_view_detail::ascii_fold(static_cast<unsigned char>(c));
+        unsigned char other = static_cast<unsigned char>(folded - 'a') < 26u ? static_cast<unsigned char>(folded & ~0x20u) : folded;
+        std::size_t i = string_or_view_detail::find_first(reinterpret_cast<const unsigned char*>(p), n, string_or_view_detail::byte_eq_either_pred{ folded, other });
+        return i == n ? nullptr : p + i;
+    }
+};
+
+// Hashes char strings so that strings equal with ascii_ci_char_traits hash the same, whatever traits they are held with
+// (so a table of ci_string_or_view can be probed with a plain std::string_view)
+struct ascii_ci_hash {
+    using is_transparent = void;
+
+    template<typename Traits>
+    [[nodiscard]] std::size_t operator()(std::basic_string_view<char, Traits> s) const noexcept {
+        return static_cast<std::size_t>(string_or_view_detail::ascii_ci_hash_bytes(reinterpret_cast<const unsigned char*>(s.data()), s.size()));
+    }
+    template<typename Traits, typename Allocator>
+    [[nodiscard]] std::size_t operator()(const std::basic_string<char, Traits, Allocator>& s) const noexcept {
+        return (*this)(std::basic_string_view<char, Traits>(s));
+    }
+    template<typename Traits, typename Allocator>
+    [[nodiscard]] std::size_t operator()(const basic_string_or_view<char, Traits, Allocator>& s) const noexcept {
+        return (*this)(*s);
+    }
+};
+
+namespace std {
+
+    // Also used by std::hash<basic_string_or_view<char, ascii_ci_char_traits, Allocator>>
+    template<>
+    struct hash<basic_string_view<char, ascii_ci_char_traits>> {
+        [[nodiscard]] size_t operator()(basic_string_view<char, ascii_ci_char_traits> s) const noexcept { return ascii_ci_hash()(s); }
+    };
+
+    template<typename Allocator>
+    struct hash<basic_string<char, ascii_ci_char_traits, Allocator>> {
+        [[nodiscard]] size_t operator()(const basic_string<char, ascii_ci_char_traits, Allocator>& s) const noexcept { return ascii_ci_hash()(s); }
+    };
+
+}
+
+using ci_string_view = std::basic_string_view<char, ascii_ci_char_traits>;
+using ci_string_or_view = basic_string_or_view<char, ascii_ci_char_traits>;  // string_or_view::replace_traits<ascii_ci_char_traits>
+
+namespace pmr {
+    using ci_string_or_view = basic_string_or_view<char, ascii_ci_char_traits, std::pmr::polymorphic_allocator<char>>;
+}
+
+#endif  // STRING_OR_VIEW_CI_H
@@ -0,0 +1,316 @@
+#ifndef STRING_OR_VIEW_COLUMN_H
+#define STRING_OR_VIEW_COLUMN_H
+
+// string_or_view_column: a column of strings stored like an Arrow string array.
+//
+//     string_or_view_column<string_or_view> col;
+//     col.push_back_copy(buffer_slice);  // Copied into the column's data buffer
+//     col.push_back_view("literal");  // Referenced, must outlive the column
+//     col.push_back(sov);  // Referenced if sov is viewing, copied if owning
+//     for (std::string_view s : col) {}
+//
+// Copied strings are stored back to back in one data buffer, with a 32 bit offset per element (so 4 bytes per element
+// plus the string data, instead of sizeof(string_or_view) plus a heap allocation per long string).
+// Referenced strings are kept in a side array, found through a bitmap with a running count every 64 elements. No bitmap
+// is allocated until the first referenced string is added.
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "string_or_view.h"
+
+namespace string_or_view_detail {
+
+    [[nodiscard]] inline std::size_t popcount(std::uint64_t x) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return std::bitset<64>(x).count();
+#else
+        return static_cast<std::size_t>(__builtin_popcountll(x));
+#endif
+    }
+
+}  // namespace string_or_view_detail
+
+template<typename StringOrView>
+class string_or_view_column {
+public:
+    using value_type = StringOrView;
+    using char_type = typename value_type::char_type;
+    using traits_type = typename value_type::traits_type;
+    using allocator_type = typename value_type::allocator_type;
+    using string_view_type = typename value_type::string_view_type;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using offset_type = std::uint32_t;
+
+    // Random access iterator over the elements as string_view_type
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = string_view_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = string_view_type;
+        using pointer = void;
+
+        constexpr const_iterator() noexcept : column(nullptr), index(0) {}
+
+        [[nodiscard]] reference operator*() const noexcept { return (*column)[index]; }
+        [[nodiscard]] reference operator[](difference_type n) const noexcept { return (*column)[index + static_cast<size_type>(n)]; }
+
+        const_iterator& operator++() noexcept { ++index; return *this; }
+        const_iterator operator++(int) noexcept { const_iterator copy = *this; ++index; return copy; }
+        const_iterator& operator--() noexcept { --index; return *this; }
+        const_iterator operator--(int) noexcept { const_iterator copy = *this; --index; return copy; }
+        const_iterator& operator+=(difference_type n) noexcept { index += static_cast<size_type>(n); return *this; }
+        const_iterator& operator-=(difference_type n) noexcept { index -= static_cast<size_type>(n); return *this; }
+        [[nodiscard]] friend const_iterator operator+(const_iterator it, difference_type n) noexcept { return it += n; }
+        [[nodiscard]] friend const_iterator operator+(difference_type n, const_iterator it) noexcept { return it += n; }
+        [[nodiscard]] friend const_iterator operator-(const_iterator it, difference_type n) noexcept { return it -= n; }
+        [[nodiscard]] friend difference_type operator-(const const_iterator& l, const const_iterator& r) noexcept {
+            return static_cast<difference_type>(l.index) - static_cast<difference_type>(r.index);
+        }
+
+        [[nodiscard]] friend bool operator==(const const_iterator& l, const const_iterator& r) noexcept { return l.index == r.index; }
+        [[nodiscard]] friend bool operator!=(const const_iterator& l, const const_iterator& r) noexcept { return l.index != r.index; }
+        [[nodiscard]] friend bool operator<(const const_iterator& l, const const_iterator& r) noexcept { return l.index < r.index; }
+        [[nodiscard]] friend bool operator>(const const_iterator& l, const const_iterator& r) noexcept { return l.index > r.index; }
+        [[nodiscard]] friend bool operator<=(const const_iterator& l, const const_iterator& r) noexcept { return l.index <= r.index; }
+        [[nodiscard]] friend bool operator>=(const const_iterator& l, const const_iterator& r) noexcept { return l.index >= r.index; }
+
+    private:
+        friend class string_or_view_column;
+
+        constexpr const_iterator(const string_or_view_column* column, size_type index) noexcept : column(column), index(index) {}
+
+        const string_or_view_column* column;
+        size_type index;
+    };
+
+    using iterator = const_iterator;
+
+    string_or_view_column() = default;
+    explicit string_or_view_column(const allocator_type& alloc)
+        : data_(alloc), offsets_(offset_allocator(alloc)), views_(view_allocator(alloc)), view_bits_(word_allocator(alloc)), view_rank_(rank_allocator(alloc)) {}
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return data_.get_allocator(); }
+
+    [[nodiscard]] size_type size() const noexcept { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    // Code units in the data buffer (copied strings)
+    [[nodiscard]] size_type payload_size() const noexcept { return data_.size(); }
+    // Number of referenced strings
+    [[nodiscard]] size_type view_count() const noexcept { return views_.size(); }
+    // Bytes allocated by the column (not counting the data of referenced strings)
+    [[nodiscard]] size_type memory_usage() const noexcept {
+        return data_.capacity() * sizeof(char_type) + offsets_.capacity() * sizeof(offset_type) +
+            views_.capacity() * sizeof(string_view_type) + view_bits_.capacity() * sizeof(std::uint64_t) + view_rank_.capacity() * sizeof(size_type);
+    }
+
+    // Room for `elements` more elements, and `payload` more code units of copied strings
+    void reserve(size_type elements, size_type payload = 0) {
+        offsets_.reserve(size() + elements + 1);
+        data_.reserve(data_.size() + payload);
+    }
+
+    void shrink_to_fit() {
+        data_.shrink_to_fit();
+        offsets_.shrink_to_fit();
+        views_.shrink_to_fit();
+        view_bits_.shrink_to_fit();
+        view_rank_.shrink_to_fit();
+    }
+
+    void clear() noexcept {
+        data_.clear();
+        offsets_.clear();
+        views_.clear();
+        view_bits_.clear();
+        view_rank_.clear();
+    }
+
+    void swap(string_or_view_column& other) noexcept {
+        data_.swap(other.data_);
+        offsets_.swap(other.offsets_);
+        views_.swap(other.views_);
+        view_bits_.swap(other.view_bits_);
+        view_rank_.swap(other.view_rank_);
+    }
+    friend void swap(string_or_view_column& l, string_or_view_column& r) noexcept { l.swap(r); }
+
+    // Copy s into the data buffer. s may point into this column. If this throws, the column is unchanged
+    void push_back_copy(string_view_type s) {
+        check_payload(s.size());
+        if (!data_.empty() && s.data() >= data_.data() && s.data() < data_.data() + data_.size()) {
+            size_type pos = static_cast<size_type>(s.data() - data_.data());
+            data_.reserve(data_.size() + s.size());
+            s = string_view_type(data_.data() + pos, s.size());
+        }
+        begin_element();
+        size_type old_size = data_.size();
+        data_.insert(data_.end(), s.begin(), s.end());
+        try {
+            offsets_.push_back(static_cast<offset_type>(data_.size()));
+        } catch (...) {
+            // Otherwise the bytes would become part of the next element
+            data_.resize(old_size);
+            throw;
+        }
+    }
+
+    // Reference s, which must outlive the column. If this throws, the column is unchanged
+    void push_back_view(string_view_type s) {
+        begin_element();
+        size_type i = size();
+        ensure_bitmap(i);
+        views_.push_back(s);
+        try {
+            offsets_.push_back(offsets_.back());
+        } catch (...) {
+            views_.pop_back();
+            throw;
+        }
+        // Only once nothing else can throw, so a failed push can't leave element i marked as a view
+        view_bits_[i / 64] |= std::uint64_t{1} << (i % 64);
+    }
+
+    // Reference s if it is viewing, copy it if it is owning
+    void push_back(const value_type& s) {
+        if (s.is_owning()) push_back_copy(*s);
+        else push_back_view(*s);
+    }
+
+    // Batch versions of push_back_copy, push_back_view and push_back. With forward iterators, copied strings are measured first
+    // so the buffers grow once
+    template<typename InputIt>
+    void append_copy(InputIt first, InputIt last) {
+        if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+            size_type elements = 0;
+            size_type payload = 0;
+            for (InputIt it = first; it != last; ++it) {
+                ++elements;
+                payload += string_view_type(*it).size();
+            }
+            check_payload(payload);
+            reserve(elements, payload);
+        }
+        for (; first != last; ++first) push_back_copy(string_view_type(*first));
+    }
+
+    template<typename InputIt>
+    void append_views(InputIt first, InputIt last) {
+        if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+            size_type elements = static_cast<size_type>(std::distance(first, last));
+            reserve(elements);
+            views_.reserve(views_.size() + elements);
+        }
+        for (; first != last; ++first) push_back_view(string_view_type(*first));
+    }
+
+    template<typename InputIt>
+    void append(InputIt first, InputIt last) {
+        if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+            size_type elements = 0;
+            size_type payload = 0;
+            for (InputIt it = first; it != last; ++it) {
+                ++elements;
+                const value_type& s = *it;
+                if (s.is_owning()) payload += s->size();
+            }
+            check_payload(payload);
+            reserve(elements, payload);
+        }
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    // Remove the last element
+    void pop_back() noexcept {
+        size_type i = size() - 1;
+        if (is_view(i)) {
+            views_.pop_back();
+            view_bits_[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+        }
+        offsets_.pop_back();
+        data_.resize(offsets_.back());
+        if (offsets_.size() == 1) offsets_.clear();
+        if (view_bits_.size() > (size() + 63) / 64) {
+            view_bits_.pop_back();
+            view_rank_.pop_back();
+        }
+    }
+
+    // Whether element i is a referenced string (rather than copied into the data buffer)
+    [[nodiscard]] bool is_view(size_type i) const noexcept {
+        return i / 64 < view_bits_.size() && ((view_bits_[i / 64] >> (i % 64)) & 1u);
+    }
+
+    [[nodiscard]] string_view_type operator[](size_type i) const noexcept {
+        if (is_view(i)) {
+            std::uint64_t before = view_bits_[i / 64] & ((std::uint64_t{1} << (i % 64)) - 1u);
+            return views_[view_rank_[i / 64] + string_or_view_detail::popcount(before)];
+        }
+        return string_view_type(data_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    [[nodiscard]] string_view_type at(size_type i) const {
+        if (i >= size()) throw std::out_of_range("string_or_view_column::at");
+        return (*this)[i];
+    }
+
+    [[nodiscard]] string_view_type front() const noexcept { return (*this)[0]; }
+    [[nodiscard]] string_view_type back() const noexcept { return (*this)[size() - 1]; }
+
+    // Element i as a viewing value_type (into the column for copied strings)
+    [[nodiscard]] value_type get(size_type i) const noexcept { return value_type((*this)[i]); }
+
+    [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+    [[nodiscard]] const_iterator end() const noexcept { return const_iterator(this, size()); }
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+private:
+    using offset_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<offset_type>;
+    using view_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<string_view_type>;
+    using word_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<std::uint64_t>;
+    using rank_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<size_type>;
+
+    void check_payload(size_type added) const {
+        if (added > std::numeric_limits<offset_type>::max() - data_.size()) throw std::length_error("string_or_view_column: data buffer exceeds 32 bit offsets");
+    }
+
+    void begin_element() {
+        if (offsets_.empty()) offsets_.push_back(0);
+        if (!view_bits_.empty()) ensure_bitmap(size());
+    }
+
+    // Make the bitmap cover element i. New words start after every referenced string so far. Words past the last element
+    // (left by a push that threw afterwards) are harmless: they have no bits set, and their rank is still right
+    void ensure_bitmap(size_type i) {
+        while (view_bits_.size() <= i / 64) {
+            view_rank_.push_back(views_.size());
+            try {
+                view_bits_.push_back(0);
+            } catch (...) {
+                view_rank_.pop_back();
+                throw;
+            }
+        }
+    }
+
+    std::vector<char_type, allocator_type> data_;
+    std::vector<offset_type, offset_allocator> offsets_;  // size() + 1 entries (or none while empty). Referenced strings take no space in data_
+    std::vector<string_view_type, view_allocator> views_;  // Referenced strings, in order
+    std::vector<std::uint64_t, word_allocator> view_bits_;  // Bit i set iff element i is in views_
+    std::vector<size_type, rank_allocator> view_rank_;  // view_rank_[w]: the number of referenced strings before element 64 * w
+};
+
+#endif  // STRING_OR_VIEW_COLUMN_H
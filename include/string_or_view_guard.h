@@ -0,0 +1,359 @@
+#ifndef STRING_OR_VIEW_GUARD_H
+#define STRING_OR_VIEW_GUARD_H
+
+// Views into a reusable buffer that are copied out (all into one allocation, from StringOrView's allocator type) before the buffer is reused.
+//
+//     source_guard<string_or_view> guard(buffer);
+//     guarded_string_or_view<string_or_view> name = guard.view(buffer.substr(4, 10));  // A view, registered with the guard
+//     kept.push_back(std::move(name));
+//     guard.reset(refill(buffer));  // Copies `kept.back()` (and any other views still alive) into one shared allocation first
+//
+// Registering is linking the guarded_string_or_view into an intrusive list in the guard (no allocation), and destroying it unlinks it.
+// So views that die before the buffer is reused cost nothing, and the ones that survive cost one allocation between all of them.
+// A guard and the guarded_string_or_view registered with it must be used from one thread at a time.
+//
+// Define STRING_OR_VIEW_GUARD_DEBUG as 1 to check for misuse: registering with a released guard, registering a string that isn't in the
+// buffer, and guarded_string_or_view objects that were copied bytewise. Failures call STRING_OR_VIEW_GUARD_FAIL(message) (by default,
+// print the message and abort). With AddressSanitizer, the buffer is also poisoned from release() until reset() or the guard is destroyed,
+// so reads through a plain view obtained from a guarded_string_or_view (e.g., `std::string_view v = *name;`) are reported.
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "string_or_view.h"
+
+#ifndef STRING_OR_VIEW_GUARD_DEBUG
+#define STRING_OR_VIEW_GUARD_DEBUG 0
+#endif
+
+#if STRING_OR_VIEW_GUARD_DEBUG
+#ifndef STRING_OR_VIEW_GUARD_FAIL
+#include <cstdio>
+#include <cstdlib>
+#define STRING_OR_VIEW_GUARD_FAIL(message) (static_cast<void>(std::fprintf(stderr, "string_or_view guard: %s\n", message)), std::abort())
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define STRING_OR_VIEW_GUARD_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define STRING_OR_VIEW_GUARD_ASAN 1
+#endif
+#endif
+#ifdef STRING_OR_VIEW_GUARD_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+#endif
+
+template<typename StringOrView>
+class source_guard;
+
+namespace string_or_view_detail {
+
+    // A node in a source_guard's circular list of registered views. Not in a list when next is null
+    struct guard_link {
+        guard_link* prev = nullptr;
+        guard_link* next = nullptr;
+
+        [[nodiscard]] bool linked() const noexcept { return next != nullptr; }
+
+        void link_after(guard_link& at) noexcept {
+            prev = &at;
+            next = at.next;
+            at.next->prev = this;
+            at.next = this;
+        }
+
+        void unlink() noexcept {
+            if (next == nullptr) return;
+            prev->next = next;
+            next->prev = prev;
+            prev = next = nullptr;
+        }
+
+        // Take the place of `other` (which must be linked) in its list
+        void replace(guard_link& other) noexcept {
+            prev = other.prev;
+            next = other.next;
+            prev->next = this;
+            next->prev = this;
+            other.prev = other.next = nullptr;
+        }
+    };
+
+    // The characters of views promoted together, in one allocation with their reference count and a copy of the allocator
+    // (rebound to the header type, so that the characters after the header are suitably aligned)
+    template<typename CharT, typename Allocator>
+    class shared_chars {
+        struct header {
+            std::atomic<std::size_t> references;
+            std::size_t count;  // Allocated size, in headers
+            Allocator alloc;
+        };
+        using header_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<header>;
+        using header_traits = std::allocator_traits<header_allocator>;
+        static_assert(std::is_same<typename header_traits::pointer, header*>::value, "Promoting guarded views needs an allocator with plain pointers");
+
+    public:
+        shared_chars() noexcept = default;
+        // Uninitialized room for `size` code units (size != 0)
+        shared_chars(std::size_t size, const Allocator& alloc) {
+            std::size_t count = 1 + (size * sizeof(CharT) + sizeof(header) - 1) / sizeof(header);
+            header_allocator a(alloc);
+            block = header_traits::allocate(a, count);
+            ::new (static_cast<void*>(block)) header{ { 1 }, count, alloc };
+        }
+
+        shared_chars(const shared_chars& other) noexcept : block(other.block) {
+            if (block) block->references.fetch_add(1, std::memory_order_relaxed);
+        }
+        shared_chars(shared_chars&& other) noexcept : block(std::exchange(other.block, nullptr)) {}
+        shared_chars& operator=(shared_chars other) noexcept {
+            std::swap(block, other.block);
+            return *this;
+        }
+        ~shared_chars() { reset(); }
+
+        void reset() noexcept {
+            header* b = std::exchange(block, nullptr);
+            if (!b || b->references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            header_allocator a(b->alloc);
+            std::size_t count = b->count;
+            b->~header();
+            header_traits::deallocate(a, b, count);
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept { return block != nullptr; }
+        [[nodiscard]] CharT* data() const noexcept { return reinterpret_cast<CharT*>(block + 1); }
+
+    private:
+        header* block = nullptr;
+    };
+
+}  // namespace string_or_view_detail
+
+// A StringOrView (a basic_string_or_view) that, if it was returned by source_guard::view, stays registered with that guard until it is
+// promoted (copied into an allocation shared with the other views promoted at the same time), reassigned or destroyed
+template<typename StringOrView>
+class guarded_string_or_view : private string_or_view_detail::guard_link {
+public:
+    using string_or_view_type = StringOrView;
+    using char_type = typename StringOrView::char_type;
+    using traits_type = typename StringOrView::traits_type;
+    using string_type = typename StringOrView::string_type;
+    using string_view_type = typename StringOrView::string_view_type;
+    using allocator_type = typename StringOrView::allocator_type;
+
+    guarded_string_or_view() noexcept = default;
+    // Not registered: `value` must be owning or outlive *this
+    guarded_string_or_view(StringOrView value) noexcept : value_(static_cast<StringOrView&&>(value)) {}
+
+    // A copy of a registered view is registered with the same guard
+    guarded_string_or_view(const guarded_string_or_view& other) : guard_link(), value_(other.value_), keep_alive(other.keep_alive) {
+        if (other.linked()) link_after(const_cast<guarded_string_or_view&>(other));
+    }
+    // Takes over other's registration. Afterwards, `other` is empty
+    guarded_string_or_view(guarded_string_or_view&& other) noexcept : guard_link(), value_(static_cast<StringOrView&&>(other.value_)), keep_alive(static_cast<shared_chars&&>(other.keep_alive)) {
+        other.value_ = StringOrView();
+        if (other.linked()) replace(other);
+    }
+
+    guarded_string_or_view& operator=(const guarded_string_or_view& other) {
+        if (this != &other) {
+            StringOrView copy = other.value_;
+            unlink();
+            value_ = static_cast<StringOrView&&>(copy);
+            keep_alive = other.keep_alive;
+            if (other.linked()) link_after(const_cast<guarded_string_or_view&>(other));
+        }
+        return *this;
+    }
+    guarded_string_or_view& operator=(guarded_string_or_view&& other) noexcept {
+        if (this != &other) {
+            unlink();
+            value_ = static_cast<StringOrView&&>(other.value_);
+            other.value_ = StringOrView();
+            keep_alive = static_cast<shared_chars&&>(other.keep_alive);
+            if (other.linked()) replace(other);
+        }
+        return *this;
+    }
+    // Unregisters. `value` must be owning or outlive *this
+    guarded_string_or_view& operator=(StringOrView value) noexcept {
+        unlink();
+        value_ = static_cast<StringOrView&&>(value);
+        keep_alive.reset();
+        return *this;
+    }
+
+    ~guarded_string_or_view() { unlink(); }
+
+    [[nodiscard]] const StringOrView& value() const noexcept { check(); return value_; }
+    [[nodiscard]] string_view_type get() const noexcept { check(); return *value_; }
+    [[nodiscard]] string_view_type operator*() const noexcept { return get(); }
+    [[nodiscard]] const StringOrView* operator->() const noexcept { check(); return &value_; }
+
+    // Still viewing the guard's buffer
+    [[nodiscard]] bool is_registered() const noexcept { return linked(); }
+    // Viewing an allocation shared with the other views promoted with it
+    [[nodiscard]] bool is_promoted() const noexcept { return static_cast<bool>(keep_alive); }
+
+    // A StringOrView that is safe to use without *this: the held value if it is owning or not from a guard, otherwise an owning copy.
+    // Afterwards, *this is empty and unregistered
+    [[nodiscard]] StringOrView take() {
+        check();
+        StringOrView result = linked() || is_promoted() ? StringOrView(string_type(*value_)) : static_cast<StringOrView&&>(value_);
+        *this = StringOrView();
+        return result;
+    }
+
+    friend void swap(guarded_string_or_view& l, guarded_string_or_view& r) noexcept {
+        guarded_string_or_view tmp(static_cast<guarded_string_or_view&&>(l));
+        l = static_cast<guarded_string_or_view&&>(r);
+        r = static_cast<guarded_string_or_view&&>(tmp);
+    }
+
+private:
+    friend class source_guard<StringOrView>;
+
+    void check() const noexcept {
+#if STRING_OR_VIEW_GUARD_DEBUG
+        if (linked() && (prev->next != this || next->prev != this)) STRING_OR_VIEW_GUARD_FAIL("registered guarded_string_or_view was copied bytewise");
+#endif
+    }
+
+    using shared_chars = string_or_view_detail::shared_chars<char_type, allocator_type>;
+
+    StringOrView value_;
+    shared_chars keep_alive;
+};
+
+// Keeps track of the guarded_string_or_view objects viewing a buffer, to copy them out before the buffer is reused or freed.
+// Not copyable or movable (the registered views point to it)
+template<typename StringOrView>
+class source_guard {
+public:
+    using guarded_type = guarded_string_or_view<StringOrView>;
+    using char_type = typename StringOrView::char_type;
+    using traits_type = typename StringOrView::traits_type;
+    using string_view_type = typename StringOrView::string_view_type;
+    using allocator_type = typename StringOrView::allocator_type;
+    using size_type = std::size_t;
+
+    // `alloc` is used for the allocations promote() makes
+    explicit source_guard(string_view_type buffer = string_view_type(), const allocator_type& alloc = allocator_type()) noexcept
+        : source(buffer), alloc(alloc) { head.prev = head.next = &head; }
+
+    source_guard(const source_guard&) = delete;
+    source_guard& operator=(const source_guard&) = delete;
+
+    // Promotes every registered view. If the shared allocation fails, each view is copied into its own string instead (short ones need
+    // no allocation), and a view that can't be copied either is left empty rather than dangling
+    ~source_guard() {
+        try {
+            promote();
+        } catch (...) {
+            promote_each();
+        }
+        unpoison();
+    }
+
+    [[nodiscard]] string_view_type buffer() const noexcept { return source; }
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return alloc; }
+
+    // Whether any registered views are still alive
+    [[nodiscard]] bool has_dependents() const noexcept { return head.next != &head; }
+
+    // A view of `piece` (which must be inside buffer()) registered with this guard
+    [[nodiscard]] guarded_type view(string_view_type piece) noexcept {
+#if STRING_OR_VIEW_GUARD_DEBUG
+        if (released) STRING_OR_VIEW_GUARD_FAIL("view() on a released source_guard (call reset() first)");
+        std::less<const char_type*> before;
+        if (!piece.empty() && (before(piece.data(), source.data()) || before(source.data() + source.size(), piece.data() + piece.size()))) {
+            STRING_OR_VIEW_GUARD_FAIL("view() of a string outside of the guarded buffer");
+        }
+#endif
+        guarded_type result{ StringOrView(piece) };
+        result.link_after(head);
+        return result;
+    }
+    // view(buffer().substr(pos, n))
+    [[nodiscard]] guarded_type view(size_type pos, size_type n) { return view(source.substr(pos, n)); }
+
+    // Copy every registered view that is still alive into one new allocation from get_allocator() (each followed by a null character,
+    // so the promoted views are is_null_terminated()) and unregister them. The reference count shares that allocation. The guard is
+    // still bound to the same buffer
+    void promote() {
+        size_type total = 0;
+        for (string_or_view_detail::guard_link* l = head.next; l != &head; l = l->next) total += static_cast<guarded_type*>(l)->value_.size() + 1;
+        if (total == 0) return;
+        string_or_view_detail::shared_chars<char_type, allocator_type> block(total, alloc);
+        char_type* out = block.data();
+        for (string_or_view_detail::guard_link* l = head.next; l != &head;) {
+            guarded_type& g = *static_cast<guarded_type*>(l);
+            l = l->next;
+            string_view_type v = *g.value_;
+            if (!v.empty()) traits_type::copy(out, v.data(), v.size());
+            traits_type::assign(out[v.size()], char_type());
+            g.value_ = StringOrView(null_terminated_tag(), string_view_type(out, v.size()));
+            g.keep_alive = block;
+            g.unlink();
+            out += v.size() + 1;
+        }
+    }
+
+    // promote(), then stop using the buffer. view() can't be called until reset()
+    void release() {
+        promote();
+#if STRING_OR_VIEW_GUARD_DEBUG
+        released = true;
+#ifdef STRING_OR_VIEW_GUARD_ASAN
+        if (!source.empty()) ASAN_POISON_MEMORY_REGION(source.data(), source.size() * sizeof(char_type));
+#endif
+#endif
+    }
+
+    // promote(), then guard `buffer` instead (which may be the same memory with new contents)
+    void reset(string_view_type buffer = string_view_type()) {
+        promote();
+        unpoison();
+        source = buffer;
+    }
+
+private:
+    void promote_each() noexcept {
+        while (has_dependents()) {
+            guarded_type& g = *static_cast<guarded_type*>(head.next);
+            g.unlink();
+            string_view_type v = *g.value_;
+            try {
+                g.value_ = StringOrView(typename StringOrView::string_type(v.data(), v.size(), alloc));
+            } catch (...) {
+                g.value_ = StringOrView();
+            }
+        }
+    }
+
+    void unpoison() noexcept {
+#if STRING_OR_VIEW_GUARD_DEBUG
+#ifdef STRING_OR_VIEW_GUARD_ASAN
+        if (released && !source.empty()) ASAN_UNPOISON_MEMORY_REGION(source.data(), source.size() * sizeof(char_type));
+#endif
+        released = false;
+#endif
+    }
+
+    string_or_view_detail::guard_link head;
+    string_view_type source;
+    allocator_type alloc;
+#if STRING_OR_VIEW_GUARD_DEBUG
+    bool released = false;
+#endif
+};
+
+#endif  // STRING_OR_VIEW_GUARD_H
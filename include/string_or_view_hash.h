@@ -0,0 +1,149 @@
+#ifndef STRING_OR_VIEW_HASH_H
+#define STRING_OR_VIEW_HASH_H
+
+// Batch hashing, a batched lookup helper that prefetches buckets ahead of probing them, and a faster string hasher.
+//
+//     hash_batch(keys.data(), keys.size(), hashes.data());  // hashes[i] == std::hash<Key>()(keys[i])
+//     hash_batch(keys.data(), keys.size(), hashes.data(), string_or_view_hash());  // Or any other hasher
+//     batch_lookup(keys.data(), keys.size(),
+//         [&](std::size_t hash) { return &table[hash & mask]; },  // What to prefetch for a hash
+//         [&](std::size_t i, std::size_t hash) { /* find keys[i] */ });
+//     std::unordered_set<string_or_view, string_or_view_hash> set;  // string_or_view_hash is usable as a hasher directly
+//
+// hash_batch and batch_lookup take the hasher the table uses (std::hash<Key> by default), and give the same results as calling it on
+// each key. batch_lookup hashes a whole chunk of keys first, so the bucket for a key can be prefetched several probes before it is needed.
+//
+// string_or_view_hash reads 8 bytes per step through a multiply / xorshift chain, which is about twice as fast as libstdc++'s std::hash
+// on short keys (see bench/batch_hash.cpp). It is not std::hash and not stable across byte orders.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "string_or_view.h"
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace string_or_view_detail {
+
+    inline constexpr std::uint64_t hash_k0 = 0x9E3779B97F4A7C15u;
+    inline constexpr std::uint64_t hash_k1 = 0xBF58476D1CE4E5B9u;
+    inline constexpr std::uint64_t hash_k2 = 0x94D049BB133111EBu;
+
+    [[nodiscard]] inline std::uint64_t load_u64(const unsigned char* p) noexcept {
+        std::uint64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+
+    [[nodiscard]] inline std::uint32_t load_u32(const unsigned char* p) noexcept {
+        std::uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+
+    [[nodiscard]] inline std::uint64_t hash_seed(std::size_t n) noexcept { return hash_k0 ^ (static_cast<std::uint64_t>(n) * hash_k1); }
+
+    [[nodiscard]] inline std::uint64_t hash_step(std::uint64_t h, std::uint64_t v) noexcept {
+        h = (h ^ v) * hash_k1;
+        return h ^ (h >> 29);
+    }
+
+    // The last r (1 to 7) bytes before `end`, as an integer. For a fixed r, different bytes give different integers.
+    // If `whole` (the string is at least 8 bytes), this reads the 8 bytes before `end` and drops the ones already hashed
+    [[nodiscard]] inline std::uint64_t load_tail(const unsigned char* end, std::size_t r, bool whole) noexcept {
+        if (whole) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return load_u64(end - 8) << (64 - 8 * r);
+#else
+            return load_u64(end - 8) >> (64 - 8 * r);
+#endif
+        }
+        const unsigned char* p = end - r;
+        if (r >= 4) return static_cast<std::uint64_t>(load_u32(p)) | (static_cast<std::uint64_t>(load_u32(end - 4)) << 32);
+        return static_cast<std::uint64_t>(p[0]) | (static_cast<std::uint64_t>(p[r / 2]) << 8) | (static_cast<std::uint64_t>(p[r - 1]) << 16);
+    }
+
+    [[nodiscard]] inline std::uint64_t hash_mix(std::uint64_t h) noexcept {
+        h ^= h >> 32;
+        h *= hash_k2;
+        return h ^ (h >> 29);
+    }
+
+    // Hash the last n % 8 bytes and finalize
+    [[nodiscard]] inline std::uint64_t hash_finish(std::uint64_t h, const unsigned char* p, std::size_t n) noexcept {
+        std::size_t r = n % 8;
+        if (r != 0) h = hash_step(h, load_tail(p + n, r, n >= 8));
+        return hash_mix(h);
+    }
+
+    [[nodiscard]] inline std::uint64_t hash_bytes(const unsigned char* p, std::size_t n) noexcept {
+        std::uint64_t h = hash_seed(n);
+        std::size_t blocks = n / 8;
+        for (std::size_t b = 0; b != blocks; ++b) h = hash_step(h, load_u64(p + 8 * b));
+        return hash_finish(h, p, n);
+    }
+
+    inline void prefetch(const void* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+        static_cast<void>(p);
+#endif
+    }
+
+}  // namespace string_or_view_detail
+
+// Hashes the code units of a std::basic_string_view, std::basic_string or basic_string_or_view with std::char_traits.
+// Equal strings hash the same whichever of those types they are held in
+struct string_or_view_hash {
+    using is_transparent = void;
+
+    template<typename CharT>
+    [[nodiscard]] std::size_t operator()(std::basic_string_view<CharT> s) const noexcept {
+        return static_cast<std::size_t>(string_or_view_detail::hash_bytes(reinterpret_cast<const unsigned char*>(s.data()), s.size() * sizeof(CharT)));
+    }
+    template<typename CharT, typename Allocator>
+    [[nodiscard]] std::size_t operator()(const std::basic_string<CharT, std::char_traits<CharT>, Allocator>& s) const noexcept {
+        return (*this)(std::basic_string_view<CharT>(s));
+    }
+    template<typename CharT, typename Allocator>
+    [[nodiscard]] std::size_t operator()(const basic_string_or_view<CharT, std::char_traits<CharT>, Allocator>& s) const noexcept {
+        return (*this)(*s);
+    }
+};
+
+// hashes[i] = hash(keys[i]) for i in [0, count).
+// The keys' hashes are independent, so the processor overlaps consecutive keys in this loop by itself
+// (interleaving 4 keys of string_or_view_hash by hand measured slower, since keys of different lengths need extra selects or branches)
+template<typename Key, typename Hash = std::hash<Key>>
+void hash_batch(const Key* keys, std::size_t count, std::size_t* hashes, const Hash& hash = Hash()) noexcept(noexcept(hash(*keys))) {
+    for (std::size_t i = 0; i != count; ++i) hashes[i] = static_cast<std::size_t>(hash(keys[i]));
+}
+
+// Looks up keys[0, count) in a hash table: keys are hashed with hash_batch (in chunks), then probe(i, hash) is called for each key
+// in order, after prefetching bucket_address(hash) (a pointer to the memory the probe will read first) `distance` keys ahead.
+// `hash` must be the table's hasher
+template<typename Key, typename BucketAddress, typename Probe, typename Hash = std::hash<Key>>
+void batch_lookup(const Key* keys, std::size_t count, BucketAddress&& bucket_address, Probe&& probe, std::size_t distance = 8, const Hash& hash = Hash()) {
+    constexpr std::size_t chunk = 256;
+    std::size_t hashes[chunk];
+    for (std::size_t base = 0; base < count; base += chunk) {
+        std::size_t n = count - base < chunk ? count - base : chunk;
+        hash_batch(keys + base, n, hashes, hash);
+        for (std::size_t i = 0; i != n && i != distance; ++i) string_or_view_detail::prefetch(bucket_address(hashes[i]));
+        for (std::size_t i = 0; i != n; ++i) {
+            if (i + distance < n) string_or_view_detail::prefetch(bucket_address(hashes[i + distance]));
+            probe(base + i, hashes[i]);
+        }
+    }
+}
+
+#endif  // STRING_OR_VIEW_HASH_H
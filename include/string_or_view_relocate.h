@@ -0,0 +1,339 @@
+#ifndef STRING_OR_VIEW_RELOCATE_H
+#define STRING_OR_VIEW_RELOCATE_H
+
+// Relocation (move construct into new storage + destroy the source, as one operation) of arrays of objects,
+// and `relocating_vector`, a vector that relocates its elements when it grows, inserts or erases.
+//
+// For types where is_trivially_relocatable<T>::value (which includes basic_string_or_view where the string
+// type is), relocating an array is a single memmove. When it is not, basic_string_or_view's `relocate_at` skips the empty
+// view the move constructor starts with, but that measures no faster: relocating_vector<string_or_view> has no benefit
+// over std::vector on libstdc++, where std::string is not trivially relocatable.
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "string_or_view.h"
+
+// Move construct *dest from *source and end the lifetime of *source. Returns dest.
+// (basic_string_or_view has its own overload found by argument dependent lookup)
+template<typename T>
+T* relocate_at(T* source, T* dest) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    if constexpr (is_trivially_relocatable<T>::value) {
+        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(source), sizeof(T));
+    } else {
+        ::new (static_cast<void*>(dest)) T(std::move(*source));
+        source->~T();
+    }
+    return dest;
+}
+
+// Relocate [first, first + n) to the uninitialized storage at d_first. Returns d_first + n.
+// The ranges may overlap only if d_first <= first (or for trivially relocatable types)
+template<typename T>
+T* uninitialized_relocate_n(T* first, std::size_t n, T* d_first) noexcept {
+    static_assert(is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value, "Relocation must not throw halfway through");
+    if constexpr (is_trivially_relocatable<T>::value) {
+        if (n != 0) std::memmove(static_cast<void*>(d_first), static_cast<const void*>(first), n * sizeof(T));
+        return d_first + n;
+    } else {
+        for (; n != 0; --n) {
+            relocate_at(first++, d_first++);
+        }
+        return d_first;
+    }
+}
+
+// Relocate [first, last) to the uninitialized storage at d_first. Returns the end of the relocated range
+template<typename T>
+T* uninitialized_relocate(T* first, T* last, T* d_first) noexcept {
+    return uninitialized_relocate_n(first, static_cast<std::size_t>(last - first), d_first);
+}
+
+// As uninitialized_relocate, but relocating the last element first, so the ranges may overlap if d_first >= first
+template<typename T>
+T* uninitialized_relocate_backward(T* first, T* last, T* d_first) noexcept {
+    static_assert(is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value, "Relocation must not throw halfway through");
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if constexpr (is_trivially_relocatable<T>::value) {
+        if (n != 0) std::memmove(static_cast<void*>(d_first), static_cast<const void*>(first), n * sizeof(T));
+    } else {
+        for (std::size_t i = n; i != 0; --i) {
+            relocate_at(first + (i - 1), d_first + (i - 1));
+        }
+    }
+    return d_first + n;
+}
+
+// A subset of the std::vector interface, where moving elements to new storage always uses relocation
+// (So reallocation and erasure is a memmove for trivially relocatable types like basic_string_or_view on libc++ and msvc)
+template<typename T, typename Allocator = std::allocator<T>>
+class relocating_vector {
+    static_assert(is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value, "relocating_vector requires types that can be relocated without throwing");
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    relocating_vector() noexcept(noexcept(Allocator())) : relocating_vector(Allocator()) {}
+    explicit relocating_vector(const Allocator& alloc) noexcept : storage(alloc) {}
+    relocating_vector(std::initializer_list<T> init, const Allocator& alloc = Allocator()) : storage(alloc) {
+        reserve(init.size());
+        for (const T& value : init) push_back(value);
+    }
+
+    relocating_vector(const relocating_vector& other) : storage(alloc_traits::select_on_container_copy_construction(other.storage)) {
+        reserve(other.size());
+        for (const T& value : other) push_back(value);
+    }
+    relocating_vector(relocating_vector&& other) noexcept : storage(static_cast<Allocator&&>(other.storage)) {
+        storage.take(other.storage);
+    }
+
+    relocating_vector& operator=(const relocating_vector& other) {
+        if (this != std::addressof(other)) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                destroy_and_deallocate();
+                static_cast<Allocator&>(storage) = static_cast<const Allocator&>(other.storage);
+            } else {
+                clear();
+            }
+            reserve(other.size());
+            for (const T& value : other) push_back(value);
+        }
+        return *this;
+    }
+
+    relocating_vector& operator=(relocating_vector&& other) noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+        if (this == std::addressof(other)) return *this;
+        if (alloc_traits::propagate_on_container_move_assignment::value || get_allocator() == other.get_allocator()) {
+            destroy_and_deallocate();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                static_cast<Allocator&>(storage) = static_cast<Allocator&&>(other.storage);
+            }
+            storage.take(other.storage);
+        } else {
+            clear();
+            reserve(other.size());
+            for (T& value : other) push_back(std::move(value));
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~relocating_vector() {
+        destroy_and_deallocate();
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return storage; }
+
+    [[nodiscard]] iterator begin() noexcept { return storage.first; }
+    [[nodiscard]] const_iterator begin() const noexcept { return storage.first; }
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+    [[nodiscard]] iterator end() noexcept { return storage.last; }
+    [[nodiscard]] const_iterator end() const noexcept { return storage.last; }
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+    [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    [[nodiscard]] bool empty() const noexcept { return storage.first == storage.last; }
+    [[nodiscard]] size_type size() const noexcept { return static_cast<size_type>(storage.last - storage.first); }
+    [[nodiscard]] size_type capacity() const noexcept { return static_cast<size_type>(storage.end_of_storage - storage.first); }
+    [[nodiscard]] size_type max_size() const noexcept { return alloc_traits::max_size(storage); }
+
+    [[nodiscard]] reference operator[](size_type pos) noexcept { return storage.first[pos]; }
+    [[nodiscard]] const_reference operator[](size_type pos) const noexcept { return storage.first[pos]; }
+    reference at(size_type pos) {
+        if (pos >= size()) throw std::out_of_range("relocating_vector::at");
+        return storage.first[pos];
+    }
+    const_reference at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("relocating_vector::at");
+        return storage.first[pos];
+    }
+    [[nodiscard]] reference front() noexcept { return *storage.first; }
+    [[nodiscard]] const_reference front() const noexcept { return *storage.first; }
+    [[nodiscard]] reference back() noexcept { return storage.last[-1]; }
+    [[nodiscard]] const_reference back() const noexcept { return storage.last[-1]; }
+    [[nodiscard]] pointer data() noexcept { return storage.first; }
+    [[nodiscard]] const_pointer data() const noexcept { return storage.first; }
+
+    void reserve(size_type new_cap) {
+        if (new_cap > capacity()) reallocate(new_cap);
+    }
+
+    void shrink_to_fit() {
+        if (capacity() != size()) reallocate(size());
+    }
+
+    void clear() noexcept {
+        destroy(storage.first, storage.last);
+        storage.last = storage.first;
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (storage.last != storage.end_of_storage) {
+            alloc_traits::construct(storage, storage.last, static_cast<Args&&>(args)...);
+            return *storage.last++;
+        }
+        return *grow_and_emplace(size(), static_cast<Args&&>(args)...);
+    }
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() noexcept {
+        alloc_traits::destroy(storage, --storage.last);
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        size_type index = static_cast<size_type>(pos - storage.first);
+        if (storage.last == storage.end_of_storage) return grow_and_emplace(index, static_cast<Args&&>(args)...);
+        if (index == size()) return std::addressof(emplace_back(static_cast<Args&&>(args)...));
+
+        // Construct first (args may refer to elements that are about to be relocated), then open the gap and relocate into it
+        alignas(T) unsigned char buffer[sizeof(T)];
+        T* value = reinterpret_cast<T*>(buffer);
+        alloc_traits::construct(storage, value, static_cast<Args&&>(args)...);
+        T* gap = storage.first + index;
+        uninitialized_relocate_backward(gap, storage.last, gap + 1);
+        ++storage.last;
+        relocate_at(value, gap);
+        return gap;
+    }
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+    iterator erase(const_iterator pos) noexcept {
+        return erase(pos, pos + 1);
+    }
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        T* f = storage.first + (first - storage.first);
+        T* l = storage.first + (last - storage.first);
+        if (f != l) {
+            if constexpr (is_trivially_relocatable<T>::value) {
+                destroy(f, l);
+                storage.last = uninitialized_relocate(l, storage.last, f);
+            } else {
+                // Same as std::vector (relocating into destroyed elements instead measured no faster)
+                T* new_last = std::move(l, storage.last, f);
+                destroy(new_last, storage.last);
+                storage.last = new_last;
+            }
+        }
+        return f;
+    }
+
+    void resize(size_type count) {
+        if (count < size()) {
+            erase(storage.first + count, storage.last);
+        } else {
+            reserve(count);
+            while (size() != count) emplace_back();
+        }
+    }
+
+    void swap(relocating_vector& other) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(static_cast<Allocator&>(storage), static_cast<Allocator&>(other.storage));
+        }
+        std::swap(storage.first, other.storage.first);
+        std::swap(storage.last, other.storage.last);
+        std::swap(storage.end_of_storage, other.storage.end_of_storage);
+    }
+    friend void swap(relocating_vector& l, relocating_vector& r) noexcept { l.swap(r); }
+
+private:
+    // Derives from the allocator so an empty allocator takes no space
+    struct storage_type : Allocator {
+        T* first = nullptr;
+        T* last = nullptr;
+        T* end_of_storage = nullptr;
+
+        explicit storage_type(const Allocator& alloc) noexcept : Allocator(alloc) {}
+        explicit storage_type(Allocator&& alloc) noexcept : Allocator(static_cast<Allocator&&>(alloc)) {}
+
+        void take(storage_type& other) noexcept {
+            first = std::exchange(other.first, nullptr);
+            last = std::exchange(other.last, nullptr);
+            end_of_storage = std::exchange(other.end_of_storage, nullptr);
+        }
+    };
+
+    [[nodiscard]] size_type grown_capacity(size_type at_least) const noexcept {
+        size_type cap = capacity();
+        size_type doubled = cap > max_size() / 2 ? max_size() : (cap == 0 ? size_type{8} : cap * 2);
+        return doubled < at_least ? at_least : doubled;
+    }
+
+    void destroy(T* first, T* last) noexcept {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (; first != last; ++first) alloc_traits::destroy(storage, first);
+        }
+    }
+
+    void destroy_and_deallocate() noexcept {
+        if (storage.first) {
+            destroy(storage.first, storage.last);
+            alloc_traits::deallocate(storage, storage.first, capacity());
+            storage.first = storage.last = storage.end_of_storage = nullptr;
+        }
+    }
+
+    // Relocate everything into new storage (never destroying or constructing elements)
+    void reallocate(size_type new_cap) {
+        T* new_first = new_cap ? alloc_traits::allocate(storage, new_cap) : nullptr;
+        T* new_last = uninitialized_relocate(storage.first, storage.last, new_first);
+        if (storage.first) alloc_traits::deallocate(storage, storage.first, capacity());
+        storage.first = new_first;
+        storage.last = new_last;
+        storage.end_of_storage = new_first + new_cap;
+    }
+
+    // Reallocate with a new element constructed at index (before relocating, since args might refer to existing elements)
+    template<typename... Args>
+    T* grow_and_emplace(size_type index, Args&&... args) {
+        size_type new_cap = grown_capacity(size() + 1);
+        T* new_first = alloc_traits::allocate(storage, new_cap);
+        T* new_element = new_first + index;
+        try {
+            alloc_traits::construct(storage, new_element, static_cast<Args&&>(args)...);
+        } catch (...) {
+            alloc_traits::deallocate(storage, new_first, new_cap);
+            throw;
+        }
+        uninitialized_relocate(storage.first, storage.first + index, new_first);
+        T* new_last = uninitialized_relocate(storage.first + index, storage.last, new_element + 1);
+        if (storage.first) alloc_traits::deallocate(storage, storage.first, capacity());
+        storage.first = new_first;
+        storage.last = new_last;
+        storage.end_of_storage = new_first + new_cap;
+        return new_element;
+    }
+
+    storage_type storage;
+};
+
+#endif  // STRING_OR_VIEW_RELOCATE_H
@@ -0,0 +1,206 @@
+#ifndef STRING_OR_VIEW_SIMD_H
+#define STRING_OR_VIEW_SIMD_H
+
+// Internal SIMD helpers shared by the string_or_view algorithm headers.
+// Only used on code units of size 1 (char, signed char, unsigned char, char8_t), where the scan can treat the
+// data as raw bytes. Everything else goes through the scalar fallbacks.
+//
+// Define STRING_OR_VIEW_NO_SIMD to force the scalar fallbacks everywhere.
+// SSE2 is used on x86-64 (or 32 bit x86 with SSE2 enabled), AVX2 additionally if the compiler targets it (e.g., `-mavx2`)
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(STRING_OR_VIEW_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define STRING_OR_VIEW_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(STRING_OR_VIEW_SIMD_SSE2) && defined(__AVX2__)
+#define STRING_OR_VIEW_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace string_or_view_detail {
+
+    // True if the SIMD byte scanners can be used for strings of CharT
+    template<typename CharT>
+    inline constexpr bool is_byte_char = sizeof(CharT) == 1 && std::is_integral<CharT>::value;
+
+    // Value of a code unit as an unsigned integer (So `static_cast<char>(-1)` is 0xFF, not -1)
+    template<typename CharT>
+    [[nodiscard]] constexpr std::uint_least32_t code_unit(CharT c) noexcept {
+        return static_cast<std::uint_least32_t>(static_cast<std::make_unsigned_t<CharT>>(c));
+    }
+
+    template<typename CharT>
+    [[nodiscard]] constexpr bool is_ascii_whitespace(CharT c) noexcept {
+        std::uint_least32_t u = code_unit(c);
+        return u == 0x20u || (u >= 0x09u && u <= 0x0Du);
+    }
+
+    [[nodiscard]] inline unsigned count_trailing_zeros(std::uint32_t x) noexcept {
+        // x must not be 0
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+    }
+
+#ifdef STRING_OR_VIEW_SIMD_SSE2
+    // 16 bytes. Every comparison returns a batch with each byte either 0x00 or 0xFF
+    struct sse2_batch {
+        static constexpr std::size_t width = 16;
+        __m128i v;
+
+        [[nodiscard]] static sse2_batch load(const unsigned char* p) noexcept { return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) }; }
+        [[nodiscard]] static sse2_batch splat(unsigned char c) noexcept { return { _mm_set1_epi8(static_cast<char>(c)) }; }
+        [[nodiscard]] static sse2_batch zero() noexcept { return { _mm_setzero_si128() }; }
+        void store(unsigned char* p) const noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+        [[nodiscard]] sse2_batch eq(sse2_batch o) const noexcept { return { _mm_cmpeq_epi8(v, o.v) }; }
+        [[nodiscard]] sse2_batch eq(unsigned char c) const noexcept { return eq(splat(c)); }
+        // lo <= byte && byte <= hi, as unsigned bytes
+        [[nodiscard]] sse2_batch in_range(unsigned char lo, unsigned char hi) const noexcept {
+            __m128i d = _mm_sub_epi8(v, _mm_set1_epi8(static_cast<char>(lo)));
+            return { _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(static_cast<char>(hi - lo))), d) };
+        }
+        // Bit i set iff the top bit of byte i is set
+        [[nodiscard]] std::uint32_t mask() const noexcept { return static_cast<std::uint32_t>(_mm_movemask_epi8(v)); }
+
+        [[nodiscard]] friend sse2_batch operator|(sse2_batch l, sse2_batch r) noexcept { return { _mm_or_si128(l.v, r.v) }; }
+        [[nodiscard]] friend sse2_batch operator&(sse2_batch l, sse2_batch r) noexcept { return { _mm_and_si128(l.v, r.v) }; }
+        [[nodiscard]] friend sse2_batch operator^(sse2_batch l, sse2_batch r) noexcept { return { _mm_xor_si128(l.v, r.v) }; }
+        // l & ~r
+        [[nodiscard]] friend sse2_batch and_not(sse2_batch l, sse2_batch r) noexcept { return { _mm_andnot_si128(r.v, l.v) }; }
+    };
+#endif
+
+#ifdef STRING_OR_VIEW_SIMD_AVX2
+    // 32 bytes. Same interface as sse2_batch
+    struct avx2_batch {
+        static constexpr std::size_t width = 32;
+        __m256i v;
+
+        [[nodiscard]] static avx2_batch load(const unsigned char* p) noexcept { return { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)) }; }
+        [[nodiscard]] static avx2_batch splat(unsigned char c) noexcept { return { _mm256_set1_epi8(static_cast<char>(c)) }; }
+        [[nodiscard]] static avx2_batch zero() noexcept { return { _mm256_setzero_si256() }; }
+        void store(unsigned char* p) const noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+        [[nodiscard]] avx2_batch eq(avx2_batch o) const noexcept { return { _mm256_cmpeq_epi8(v, o.v) }; }
+        [[nodiscard]] avx2_batch eq(unsigned char c) const noexcept { return eq(splat(c)); }
+        [[nodiscard]] avx2_batch in_range(unsigned char lo, unsigned char hi) const noexcept {
+            __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8(static_cast<char>(lo)));
+            return { _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(static_cast<char>(hi - lo))), d) };
+        }
+        [[nodiscard]] std::uint32_t mask() const noexcept { return static_cast<std::uint32_t>(_mm256_movemask_epi8(v)); }
+
+        [[nodiscard]] friend avx2_batch operator|(avx2_batch l, avx2_batch r) noexcept { return { _mm256_or_si256(l.v, r.v) }; }
+        [[nodiscard]] friend avx2_batch operator&(avx2_batch l, avx2_batch r) noexcept { return { _mm256_and_si256(l.v, r.v) }; }
+        [[nodiscard]] friend avx2_batch operator^(avx2_batch l, avx2_batch r) noexcept { return { _mm256_xor_si256(l.v, r.v) }; }
+        [[nodiscard]] friend avx2_batch and_not(avx2_batch l, avx2_batch r) noexcept { return { _mm256_andnot_si256(r.v, l.v) }; }
+    };
+#endif
+
+    // Index of the first byte in [p, p + n) that `pred` matches, or n if none do.
+    //
+    // Pred must have:
+    //     std::size_t lookahead() const;  // How many bytes past the end of a batch `match` may read
+    //     bool match_scalar(const unsigned char* p, const unsigned char* end) const;  // Does the byte at *p match
+    //     template<typename Batch> Batch match(const unsigned char* p) const;  // Each byte 0xFF iff it matches
+    template<typename Pred>
+    [[nodiscard]] std::size_t find_first(const unsigned char* p, std::size_t n, const Pred& pred) noexcept {
+        std::size_t i = 0;
+#if defined(STRING_OR_VIEW_SIMD_SSE2) || defined(STRING_OR_VIEW_SIMD_AVX2)
+        const std::size_t lookahead = pred.lookahead();
+#endif
+#ifdef STRING_OR_VIEW_SIMD_AVX2
+        if (n >= lookahead) {
+            for (; i + avx2_batch::width <= n - lookahead; i += avx2_batch::width) {
+                std::uint32_t m = pred.template match<avx2_batch>(p + i).mask();
+                if (m != 0u) return i + count_trailing_zeros(m);
+            }
+        }
+#endif
+#ifdef STRING_OR_VIEW_SIMD_SSE2
+        if (n >= lookahead) {
+            for (; i + sse2_batch::width <= n - lookahead; i += sse2_batch::width) {
+                std::uint32_t m = pred.template match<sse2_batch>(p + i).mask();
+                if (m != 0u) return i + count_trailing_zeros(m);
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            if (pred.match_scalar(p + i, p + n)) return i;
+        }
+        return n;
+    }
+
+    // Convenience for a predicate that only looks at a single code unit at a time (works for any CharT)
+    // Pred must have `bool operator()(CharT) const` as well as the `find_first` interface
+    template<typename CharT, typename Pred>
+    [[nodiscard]] std::size_t find_first_code_unit(const CharT* p, std::size_t n, const Pred& pred) noexcept {
+        if constexpr (is_byte_char<CharT>) {
+            return find_first(reinterpret_cast<const unsigned char*>(p), n, pred);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (pred(p[i])) return i;
+            }
+            return n;
+        }
+    }
+
+    // Common predicates
+
+    struct byte_eq_pred {
+        unsigned char c;
+        [[nodiscard]] std::size_t lookahead() const noexcept { return 0; }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char*) const noexcept { return *p == c; }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept { return Batch::load(p).eq(c); }
+    };
+
+    // lo <= c && c <= hi
+    struct code_unit_range_pred {
+        std::uint_least32_t lo;
+        std::uint_least32_t hi;
+        [[nodiscard]] std::size_t lookahead() const noexcept { return 0; }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char*) const noexcept { return lo <= *p && *p <= hi; }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept { return Batch::load(p).in_range(static_cast<unsigned char>(lo), static_cast<unsigned char>(hi)); }
+        template<typename CharT>
+        [[nodiscard]] bool operator()(CharT c) const noexcept { std::uint_least32_t u = code_unit(c); return lo <= u && u <= hi; }
+    };
+
+    struct ascii_whitespace_pred {
+        [[nodiscard]] std::size_t lookahead() const noexcept { return 0; }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char*) const noexcept { return is_ascii_whitespace(*p); }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept { Batch b = Batch::load(p); return b.eq(0x20) | b.in_range(0x09, 0x0D); }
+        template<typename CharT>
+        [[nodiscard]] bool operator()(CharT c) const noexcept { return is_ascii_whitespace(c); }
+    };
+
+    // Matches exactly when Pred doesn't
+    template<typename Pred>
+    struct not_pred {
+        Pred pred;
+        [[nodiscard]] std::size_t lookahead() const noexcept { return pred.lookahead(); }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char* end) const noexcept { return !pred.match_scalar(p, end); }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept { return pred.template match<Batch>(p).eq(Batch::zero()); }
+        template<typename CharT>
+        [[nodiscard]] bool operator()(CharT c) const noexcept { return !pred(c); }
+    };
+
+}  // namespace string_or_view_detail
+
+#endif  // STRING_OR_VIEW_SIMD_H
@@ -0,0 +1,294 @@
+#ifndef STRING_OR_VIEW_SORT_H
+#define STRING_OR_VIEW_SORT_H
+
+// Sorting and deduplicating ranges of basic_string_or_view.
+//
+//     string_sort(keys.begin(), keys.end());  // Same order as std::sort(keys.begin(), keys.end())
+//     keys.erase(string_sort_unique(keys.begin(), keys.end()), keys.end());  // Sort and remove duplicates
+//     string_sort(keys.begin(), keys.end(), 0);  // Use every hardware thread
+//
+// With std::char_traits for char, char8_t, char16_t or char32_t, this is a multikey quicksort (three way radix quicksort)
+// over an array holding the next 8 bytes of each string as an integer beside a pointer to its data, so most comparisons are a
+// single integer comparison and don't touch the string data. The elements themselves are only moved at the end.
+// As in introsort, a range that takes too many partitions at one depth is finished with std::sort, so inputs that defeat the
+// pivot choice are still O(n log n) (and the recursion depth is logarithmic either way).
+// Other traits fall back to std::sort with the comparison operators (and a swapping pass instead of std::unique).
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "string_or_view.h"
+#include "string_or_view_simd.h"
+
+namespace string_or_view_detail {
+
+    template<typename CharT, typename Traits>
+    inline constexpr bool can_radix_sort = std::is_same<Traits, std::char_traits<CharT>>::value && (
+        std::is_same<CharT, char>::value ||
+#ifdef __cpp_char8_t
+        std::is_same<CharT, char8_t>::value ||
+#endif
+        std::is_same<CharT, char16_t>::value ||
+        std::is_same<CharT, char32_t>::value
+    );
+
+    template<typename CharT>
+    struct sort_entry {
+        static constexpr std::size_t per_prefix = 8 / sizeof(CharT);  // Code units cached in `prefix`
+
+        std::uint64_t prefix;  // The `per_prefix` code units from the current depth, big endian and zero padded
+        std::size_t remaining;  // min(per_prefix, code units from the current depth)
+        const CharT* data;
+        std::size_t size;
+        std::size_t index;  // Original position
+
+        void load_prefix(std::size_t depth) noexcept {
+            std::size_t n = size - depth;
+            std::uint64_t v = 0;
+            const CharT* p = data + depth;
+            if (n >= per_prefix) {
+                // Fixed trip count so the compiler can turn this into a byte swapped load
+                for (std::size_t i = 0; i != per_prefix; ++i) v = (v << (8 * sizeof(CharT))) | code_unit(p[i]);
+                remaining = per_prefix;
+            } else {
+                for (std::size_t i = 0; i != n; ++i) v = (v << (8 * sizeof(CharT))) | code_unit(p[i]);
+                if (n != 0) v <<= 8 * sizeof(CharT) * (per_prefix - n);
+                remaining = n;
+            }
+            prefix = v;
+        }
+
+        // Three way comparison of the keys at the current depth (so 0 means either equal, or equal so far and both continue)
+        [[nodiscard]] int compare_key(const sort_entry& other) const noexcept {
+            if (prefix != other.prefix) return prefix < other.prefix ? -1 : 1;
+            if (remaining != other.remaining) return remaining < other.remaining ? -1 : 1;
+            return 0;
+        }
+
+        // Full comparison of the strings, knowing the first `depth` code units are equal
+        [[nodiscard]] bool less_from(const sort_entry& other, std::size_t depth) const noexcept {
+            int c = compare_key(other);
+            if (c != 0) return c < 0;
+            if (remaining < per_prefix) return false;
+            depth += per_prefix;
+            std::size_t n = std::min(size, other.size) - depth;
+            int r = std::char_traits<CharT>::compare(data + depth, other.data + depth, n);
+            return r != 0 ? r < 0 : size < other.size;
+        }
+    };
+
+    template<typename CharT>
+    void insertion_sort_entries(sort_entry<CharT>* first, sort_entry<CharT>* last, std::size_t depth) noexcept {
+        for (sort_entry<CharT>* i = first + 1; i < last; ++i) {
+            sort_entry<CharT> e = *i;
+            sort_entry<CharT>* j = i;
+            for (; j != first && e.less_from(j[-1], depth); --j) *j = j[-1];
+            *j = e;
+        }
+    }
+
+    // Partitioning steps allowed at one depth before falling back to std::sort (as in introsort): 2 * log2(n)
+    [[nodiscard]] inline std::size_t sort_depth_budget(std::size_t n) noexcept {
+        std::size_t log2 = 0;
+        while (n > 1) {
+            n >>= 1;
+            ++log2;
+        }
+        return 2 * log2;
+    }
+
+    template<typename CharT>
+    [[nodiscard]] sort_entry<CharT>* median_of_three(sort_entry<CharT>* a, sort_entry<CharT>* b, sort_entry<CharT>* c) noexcept {
+        if (b->compare_key(*a) < 0) std::swap(a, b);
+        if (c->compare_key(*b) < 0) b = c->compare_key(*a) < 0 ? a : c;
+        return b;
+    }
+
+    template<typename CharT>
+    void multikey_quicksort(sort_entry<CharT>* first, sort_entry<CharT>* last, std::size_t depth, std::size_t threads, std::size_t budget);
+
+    // The entries in [first, last) compared equal at `depth`. If they continue (`more`), sort them by the following code units
+    template<typename CharT>
+    void multikey_quicksort_equal(sort_entry<CharT>* first, sort_entry<CharT>* last, std::size_t depth, std::size_t threads, bool more) {
+        if (!more) return;
+        depth += sort_entry<CharT>::per_prefix;
+        for (sort_entry<CharT>* e = first; e != last; ++e) e->load_prefix(depth);
+        multikey_quicksort(first, last, depth, threads, sort_depth_budget(static_cast<std::size_t>(last - first)));
+    }
+
+    // All entries in [first, last) have an equal first `depth` code units, and have their prefix loaded at that depth.
+    // Only the two smaller of the three partitions are sorted recursively (each at most half of the range), and the largest in
+    // this loop, so the recursion depth is logarithmic. After `budget` partitions without moving to the next depth, bad pivots
+    // are assumed and the rest is sorted with std::sort
+    template<typename CharT>
+    void multikey_quicksort(sort_entry<CharT>* first, sort_entry<CharT>* last, std::size_t depth, std::size_t threads, std::size_t budget) {
+        constexpr std::size_t insertion_sort_threshold = 16;
+        constexpr std::size_t parallel_threshold = 1u << 14;
+        constexpr std::size_t ninther_threshold = 128;
+
+        while (static_cast<std::size_t>(last - first) > insertion_sort_threshold) {
+            if (budget == 0) {
+                std::sort(first, last, [depth](const sort_entry<CharT>& l, const sort_entry<CharT>& r) { return l.less_from(r, depth); });
+                return;
+            }
+            --budget;
+
+            std::size_t n = static_cast<std::size_t>(last - first);
+            // Median of three, or of three medians of three (Tukey's ninther) for larger ranges
+            sort_entry<CharT>* mid = first + n / 2;
+            sort_entry<CharT>* m;
+            if (n > ninther_threshold) {
+                std::size_t step = n / 8;
+                m = median_of_three(
+                    median_of_three(first, first + step, first + 2 * step),
+                    median_of_three(mid - step, mid, mid + step),
+                    median_of_three(last - 1 - 2 * step, last - 1 - step, last - 1));
+            } else {
+                m = median_of_three(first, mid, last - 1);
+            }
+            sort_entry<CharT> pivot = *m;
+
+            // [first, lt) < pivot, [lt, i) == pivot, [gt, last) > pivot
+            sort_entry<CharT>* lt = first;
+            sort_entry<CharT>* i = first;
+            sort_entry<CharT>* gt = last;
+            while (i < gt) {
+                int cmp = i->compare_key(pivot);
+                if (cmp < 0) std::swap(*lt++, *i++);
+                else if (cmp > 0) std::swap(*i, *--gt);
+                else ++i;
+            }
+            // The equal range either all ended (and are equal) or continues at the next depth
+            bool more = pivot.remaining == sort_entry<CharT>::per_prefix;
+
+            if (threads > 1 && static_cast<std::size_t>(lt - first) >= parallel_threshold) {
+                std::size_t given = threads / 2;
+                std::thread worker(multikey_quicksort<CharT>, first, lt, depth, given, budget);
+                multikey_quicksort(gt, last, depth, threads - given, budget);
+                // Continue with the equal range on this thread, then wait
+                multikey_quicksort_equal(lt, gt, depth, threads - given, more);
+                worker.join();
+                return;
+            }
+
+            std::size_t less_count = static_cast<std::size_t>(lt - first);
+            std::size_t equal_count = more ? static_cast<std::size_t>(gt - lt) : 0;
+            std::size_t greater_count = static_cast<std::size_t>(last - gt);
+            if (more && equal_count >= less_count && equal_count >= greater_count) {
+                multikey_quicksort(first, lt, depth, threads, budget);
+                multikey_quicksort(gt, last, depth, threads, budget);
+                first = lt;
+                last = gt;
+                depth += sort_entry<CharT>::per_prefix;
+                for (sort_entry<CharT>* e = first; e != last; ++e) e->load_prefix(depth);
+                budget = sort_depth_budget(equal_count);
+            } else if (less_count >= greater_count) {
+                multikey_quicksort(gt, last, depth, threads, budget);
+                multikey_quicksort_equal(lt, gt, depth, threads, more);
+                last = lt;
+            } else {
+                multikey_quicksort(first, lt, depth, threads, budget);
+                multikey_quicksort_equal(lt, gt, depth, threads, more);
+                first = gt;
+            }
+        }
+        insertion_sort_entries(first, last, depth);
+    }
+
+    // Move the elements so that the element at position i is the one that was at position order[i].
+    // Gathering into a buffer (sequential writes) then moving back is faster than following the permutation's cycles in place
+    template<typename RandomIt>
+    void apply_order(RandomIt first, const std::vector<std::size_t>& order) {
+        using value_type = typename std::iterator_traits<RandomIt>::value_type;
+        std::vector<value_type> sorted;
+        sorted.reserve(order.size());
+        for (std::size_t i : order) sorted.push_back(std::move(first[static_cast<std::ptrdiff_t>(i)]));
+        std::move(sorted.begin(), sorted.end(), first);
+    }
+
+    // Sort, then move the elements into place. If unique, duplicates are moved after the unique elements and
+    // the returned value is the number of unique elements
+    template<typename RandomIt>
+    std::size_t string_sort_impl(RandomIt first, RandomIt last, std::size_t threads, bool unique) {
+        using value_type = typename std::iterator_traits<RandomIt>::value_type;
+        using char_type = typename value_type::char_type;
+        using string_view_type = typename value_type::string_view_type;
+
+        std::size_t n = static_cast<std::size_t>(last - first);
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+        std::vector<sort_entry<char_type>> entries(n);
+        for (std::size_t i = 0; i != n; ++i) {
+            string_view_type sv = first[static_cast<std::ptrdiff_t>(i)];
+            entries[i].data = sv.data();
+            entries[i].size = sv.size();
+            entries[i].index = i;
+            entries[i].load_prefix(0);
+        }
+        multikey_quicksort(entries.data(), entries.data() + n, 0, threads, sort_depth_budget(n));
+
+        std::vector<std::size_t> order(n);
+        std::size_t unique_count = n;
+        if (unique && n != 0) {
+            // Adjacent equal strings: keep the first, put the rest at the end
+            std::size_t front = 0;
+            std::size_t back = n;
+            for (std::size_t i = 0; i != n; ++i) {
+                bool duplicate = i != 0 &&
+                    entries[i].size == entries[i - 1].size &&
+                    std::char_traits<char_type>::compare(entries[i].data, entries[i - 1].data, entries[i].size) == 0;
+                if (duplicate) order[--back] = entries[i].index;
+                else order[front++] = entries[i].index;
+            }
+            unique_count = front;
+        } else {
+            for (std::size_t i = 0; i != n; ++i) order[i] = entries[i].index;
+        }
+        entries = std::vector<sort_entry<char_type>>();
+        apply_order(first, order);
+        return unique_count;
+    }
+
+}  // namespace string_or_view_detail
+
+// Sort [first, last) (random access iterators to basic_string_or_view) in the same order as `std::sort(first, last)` would.
+// Not stable. Uses up to `threads` threads (0 for std::thread::hardware_concurrency())
+template<typename RandomIt>
+void string_sort(RandomIt first, RandomIt last, std::size_t threads = 1) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    if constexpr (string_or_view_detail::can_radix_sort<typename value_type::char_type, typename value_type::traits_type>) {
+        string_or_view_detail::string_sort_impl(first, last, threads, false);
+    } else {
+        std::sort(first, last);
+    }
+}
+
+// Sort [first, last), then move one of each group of equal elements to the front, like `std::unique(first, last)` on a sorted range.
+// Returns the end of the unique elements. The elements after that are the duplicates (in an unspecified order), not moved-from objects.
+// Which of a group of equal elements is kept is unspecified
+template<typename RandomIt>
+RandomIt string_sort_unique(RandomIt first, RandomIt last, std::size_t threads = 1) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    if constexpr (string_or_view_detail::can_radix_sort<typename value_type::char_type, typename value_type::traits_type>) {
+        return first + static_cast<typename std::iterator_traits<RandomIt>::difference_type>(string_or_view_detail::string_sort_impl(first, last, threads, true));
+    } else {
+        std::sort(first, last);
+        // Not std::unique, which leaves moved-from objects after the end: swapping keeps the duplicates intact
+        if (first == last) return last;
+        RandomIt kept = first;
+        for (RandomIt it = first; ++it != last;) {
+            if (!(*kept == *it) && ++kept != it) std::iter_swap(kept, it);
+        }
+        return ++kept;
+    }
+}
+
+#endif  // STRING_OR_VIEW_SORT_H
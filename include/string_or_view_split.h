@@ -0,0 +1,283 @@
+#ifndef STRING_OR_VIEW_SPLIT_H
+#define STRING_OR_VIEW_SPLIT_H
+
+// Lazy split ranges yielding basic_string_or_view pieces.
+//
+//     for (string_or_view field : split(line, ',')) { ... }  // Single code unit delimiter
+//     for (string_or_view field : split(line, std::string_view("::"))) { ... }  // Substring delimiter
+//     for (string_or_view field : split(line, split_any_of(" \t,"))) { ... }  // Any of a set of code units
+//
+// A single code unit delimiter is found with `string_view_type::find` (memchr for char). With the default std::char_traits and byte
+// sized code units, split_any_of and substring delimiters are found with SSE2/AVX2 when available. With other traits, those use
+// `string_view_type::find` / `find_first_of` (so the traits' `eq` decides what matches).
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "string_or_view.h"
+#include "string_or_view_simd.h"
+
+// A set of code units, any of which is a delimiter. The set must outlive the split range.
+template<typename CharT>
+struct split_any_of {
+    std::basic_string_view<CharT> set;
+
+    constexpr explicit split_any_of(std::basic_string_view<CharT> set) noexcept : set(set) {}
+    constexpr explicit split_any_of(const CharT* set) noexcept : set(set) {}
+};
+
+template<typename CharT>
+split_any_of(const CharT*) -> split_any_of<CharT>;
+
+// Whether pieces split from an owning temporary view into the split range (which keeps the string alive) or own copies
+enum class split_pieces {
+    view,  // Pieces may not outlive the split range (or its source if the source was not an owning temporary)
+    own  // Pieces own their data if the source was owning. Pieces from a viewing source are always views
+};
+
+namespace string_or_view_detail {
+
+    template<typename CharT, typename Traits>
+    inline constexpr bool can_simd_split = is_byte_char<CharT> && std::is_same<Traits, std::char_traits<CharT>>::value;
+
+    struct any_of_bytes_pred {
+        const unsigned char* set;
+        std::size_t set_size;
+        std::uint32_t table[8];  // Bit c is set iff c is in the set
+
+        [[nodiscard]] std::size_t lookahead() const noexcept { return 0; }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char*) const noexcept {
+            return (table[*p >> 5] >> (*p & 31u)) & 1u;
+        }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept {
+            Batch b = Batch::load(p);
+            Batch m = Batch::zero();
+            for (std::size_t i = 0; i != set_size; ++i) m = m | b.eq(set[i]);
+            return m;
+        }
+    };
+
+    // Candidates where the first and last code unit of the needle match, then checked with memcmp
+    struct substring_pred {
+        const unsigned char* needle;
+        std::size_t needle_size;  // > 0
+
+        [[nodiscard]] std::size_t lookahead() const noexcept { return needle_size - 1; }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char* end) const noexcept {
+            return static_cast<std::size_t>(end - p) >= needle_size && std::memcmp(p, needle, needle_size) == 0;
+        }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept {
+            return Batch::load(p).eq(needle[0]) & Batch::load(p + needle_size - 1).eq(needle[needle_size - 1]);
+        }
+    };
+
+    // Delimiters have `size()` (the number of code units skipped after a match) and
+    // `find(string_view_type s, std::size_t pos)` (s.size() if there are no more delimiters)
+
+    template<typename CharT, typename Traits>
+    struct char_delimiter {
+        CharT c;
+
+        [[nodiscard]] constexpr std::size_t size() const noexcept { return 1; }
+        // Traits::find (memchr for std::char_traits<char>), which the C library tunes for each CPU, rather than find_first with a byte_eq_pred:
+        // find_first is only ahead on very short fields (see bench/split.cpp)
+        [[nodiscard]] std::size_t find(std::basic_string_view<CharT, Traits> s, std::size_t pos) const noexcept {
+            std::size_t i = s.find(c, pos);
+            return i == s.npos ? s.size() : i;
+        }
+    };
+
+    template<typename CharT, typename Traits>
+    struct any_of_delimiter {
+        std::basic_string_view<CharT, Traits> set;
+        any_of_bytes_pred pred = {};
+
+        explicit any_of_delimiter(split_any_of<CharT> any_of) noexcept : set(any_of.set.data(), any_of.set.size()) {
+            if constexpr (can_simd_split<CharT, Traits>) {
+                pred.set = reinterpret_cast<const unsigned char*>(set.data());
+                pred.set_size = set.size();
+                for (CharT c : set) {
+                    unsigned char u = static_cast<unsigned char>(c);
+                    pred.table[u >> 5] |= std::uint32_t{1} << (u & 31u);
+                }
+            }
+        }
+
+        [[nodiscard]] constexpr std::size_t size() const noexcept { return 1; }
+        [[nodiscard]] std::size_t find(std::basic_string_view<CharT, Traits> s, std::size_t pos) const noexcept {
+            if constexpr (can_simd_split<CharT, Traits>) {
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+                // Comparing against every member of a big set is slower than the table lookup
+                if (pred.set_size > 8) {
+                    for (; pos != s.size(); ++pos) {
+                        if (pred.match_scalar(p + pos, p + s.size())) break;
+                    }
+                    return pos;
+                }
+                return pos + find_first(p + pos, s.size() - pos, pred);
+            } else {
+                std::size_t i = s.find_first_of(set, pos);
+                return i == s.npos ? s.size() : i;
+            }
+        }
+    };
+
+    template<typename CharT, typename Traits>
+    struct string_delimiter {
+        std::basic_string_view<CharT, Traits> needle;
+
+        [[nodiscard]] constexpr std::size_t size() const noexcept { return needle.size(); }
+        [[nodiscard]] std::size_t find(std::basic_string_view<CharT, Traits> s, std::size_t pos) const noexcept {
+            // An empty delimiter never matches
+            if (needle.empty()) return s.size();
+            if constexpr (can_simd_split<CharT, Traits>) {
+                substring_pred pred{ reinterpret_cast<const unsigned char*>(needle.data()), needle.size() };
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+                while (true) {
+                    pos += find_first(p + pos, s.size() - pos, pred);
+                    if (pos == s.size() || pred.match_scalar(p + pos, p + s.size())) return pos;
+                    ++pos;
+                }
+            } else {
+                std::size_t i = s.find(needle, pos);
+                return i == s.npos ? s.size() : i;
+            }
+        }
+    };
+
+    template<typename CharT, typename Traits, typename Delimiter>
+    struct delimiter_for {
+        static_assert(std::is_convertible<const Delimiter&, std::basic_string_view<CharT, Traits>>::value, "Delimiter must be a code unit, a string view or split_any_of");
+        using type = string_delimiter<CharT, Traits>;
+    };
+
+    template<typename CharT, typename Traits>
+    struct delimiter_for<CharT, Traits, CharT> {
+        using type = char_delimiter<CharT, Traits>;
+    };
+
+    template<typename CharT, typename Traits>
+    struct delimiter_for<CharT, Traits, split_any_of<CharT>> {
+        using type = any_of_delimiter<CharT, Traits>;
+    };
+
+    template<typename CharT, typename Traits, typename Delimiter>
+    using delimiter_for_t = typename delimiter_for<CharT, Traits, Delimiter>::type;
+
+    template<typename CharT, typename Traits, typename Delimiter>
+    [[nodiscard]] delimiter_for_t<CharT, Traits, Delimiter> make_delimiter(const Delimiter& d) noexcept {
+        if constexpr (std::is_same<Delimiter, CharT>::value) {
+            return { d };
+        } else if constexpr (std::is_same<Delimiter, split_any_of<CharT>>::value) {
+            return delimiter_for_t<CharT, Traits, Delimiter>(d);
+        } else {
+            return { std::basic_string_view<CharT, Traits>(d) };
+        }
+    }
+
+}  // namespace string_or_view_detail
+
+// The range returned by `split`. Iterating it finds one delimiter per increment.
+// Splitting "" gives one empty piece, and a delimiter at the start or end gives an empty piece there.
+//
+// If the source was an owning temporary, the string is moved into the range, so the range must not be moved
+// while pieces viewing into it are still in use.
+template<typename StringOrView, typename Delimiter>
+class split_range {
+public:
+    using value_type = StringOrView;
+    using string_view_type = typename value_type::string_view_type;
+    using size_type = std::size_t;
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = StringOrView;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        using pointer = void;
+
+        constexpr iterator() noexcept : range(nullptr), pos(value_type::npos), next(value_type::npos) {}
+
+        [[nodiscard]] value_type operator*() const {
+            string_view_type piece = range->source_view().substr(pos, next - pos);
+            if (range->pieces == split_pieces::own && range->source.is_owning()) {
+                return typename value_type::string_type(piece, range->source.get_allocator_or());
+            }
+            return piece;
+        }
+
+        iterator& operator++() noexcept {
+            string_view_type s = range->source_view();
+            if (next == s.size()) {
+                pos = next = value_type::npos;
+            } else {
+                pos = next + range->delimiter.size();
+                next = range->delimiter.find(s, pos);
+            }
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        [[nodiscard]] friend bool operator==(const iterator& l, const iterator& r) noexcept { return l.pos == r.pos; }
+        [[nodiscard]] friend bool operator!=(const iterator& l, const iterator& r) noexcept { return l.pos != r.pos; }
+
+    private:
+        friend class split_range;
+
+        constexpr iterator(const split_range* range, size_type pos, size_type next) noexcept : range(range), pos(pos), next(next) {}
+
+        const split_range* range;
+        size_type pos;  // Start of the current piece, or npos for end()
+        size_type next;  // End of the current piece (where the delimiter starts, or the end of the string)
+    };
+
+    using const_iterator = iterator;
+
+    split_range(value_type&& source, Delimiter delimiter, split_pieces pieces = split_pieces::view) noexcept
+        : source(static_cast<value_type&&>(source)), delimiter(delimiter), pieces(pieces) {}
+
+    [[nodiscard]] iterator begin() const noexcept { return iterator(this, 0, delimiter.find(source_view(), 0)); }
+    [[nodiscard]] iterator end() const noexcept { return iterator(); }
+
+private:
+    [[nodiscard]] string_view_type source_view() const noexcept { return *source; }
+
+    value_type source;
+    Delimiter delimiter;
+    split_pieces pieces;
+};
+
+// Split a string or view that outlives the range. Pieces are views into `s`
+template<typename CharT, typename Traits, typename Allocator, typename Delimiter>
+[[nodiscard]] split_range<basic_string_or_view<CharT, Traits, Allocator>, string_or_view_detail::delimiter_for_t<CharT, Traits, Delimiter>>
+split(const basic_string_or_view<CharT, Traits, Allocator>& s, const Delimiter& delimiter) noexcept {
+    return { basic_string_or_view<CharT, Traits, Allocator>(*s), string_or_view_detail::make_delimiter<CharT, Traits>(delimiter) };
+}
+
+// Split a temporary. If it is owning, it is moved into the range, and pieces either view into the range or own copies.
+template<typename CharT, typename Traits, typename Allocator, typename Delimiter>
+[[nodiscard]] split_range<basic_string_or_view<CharT, Traits, Allocator>, string_or_view_detail::delimiter_for_t<CharT, Traits, Delimiter>>
+split(basic_string_or_view<CharT, Traits, Allocator>&& s, const Delimiter& delimiter, split_pieces pieces = split_pieces::view) noexcept {
+    return { static_cast<basic_string_or_view<CharT, Traits, Allocator>&&>(s), string_or_view_detail::make_delimiter<CharT, Traits>(delimiter), pieces };
+}
+
+template<typename CharT, typename Traits, typename Delimiter>
+[[nodiscard]] split_range<basic_string_or_view<CharT, Traits>, string_or_view_detail::delimiter_for_t<CharT, Traits, Delimiter>>
+split(std::basic_string_view<CharT, Traits> s, const Delimiter& delimiter) noexcept {
+    return { basic_string_or_view<CharT, Traits>(s), string_or_view_detail::make_delimiter<CharT, Traits>(delimiter) };
+}
+
+#endif  // STRING_OR_VIEW_SPLIT_H
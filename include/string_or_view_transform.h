@@ -0,0 +1,449 @@
+#ifndef STRING_OR_VIEW_TRANSFORM_H
+#define STRING_OR_VIEW_TRANSFORM_H
+
+// Copy-only-if-changed string transforms.
+//
+// Every transform here returns a viewing basic_string_or_view aliasing its input if the input is already
+// unchanged by the transform, and only allocates a new owning string when some code unit actually changes.
+// If given an owning rvalue, the transform is done in place in the held string (All of these transforms never
+// make a string longer), so never allocates.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+
+#include "string_or_view.h"
+#include "string_or_view_simd.h"
+
+namespace string_or_view_detail {
+
+    template<typename CharT>
+    [[nodiscard]] constexpr int hex_digit_value(CharT c) noexcept {
+        std::uint_least32_t u = code_unit(c);
+        if (u >= 0x30u && u <= 0x39u) return static_cast<int>(u - 0x30u);
+        u |= 0x20u;
+        if (u >= 0x61u && u <= 0x66u) return static_cast<int>(u - 0x61u + 10u);
+        return -1;
+    }
+
+    // Move [p + from, p + from + count) to p + to, where to <= from
+    template<typename CharT>
+    void shift_down(CharT* p, std::size_t to, std::size_t from, std::size_t count) noexcept {
+        if (to != from) std::copy(p + from, p + from + count, p + to);
+    }
+
+    // Transforms must have:
+    //     // Index of the first code unit that would be changed, or n if the transform would do nothing
+    //     template<typename CharT> static std::size_t find(const CharT* p, std::size_t n) noexcept;
+    //     // Apply the transform in place, where `first` is the result of `find`. Returns the new size (always <= n)
+    //     template<typename CharT> static std::size_t apply(CharT* p, std::size_t n, std::size_t first) noexcept;
+
+    template<typename CharT, typename Batch>
+    std::size_t batched_case_change(CharT* p, std::size_t n, std::size_t i, unsigned char lo, unsigned char hi, bool lower) noexcept {
+        unsigned char* b = reinterpret_cast<unsigned char*>(p);
+        for (; i + Batch::width <= n; i += Batch::width) {
+            Batch v = Batch::load(b + i);
+            Batch flip = v.in_range(lo, hi) & Batch::splat(0x20);
+            (lower ? (v | flip) : and_not(v, flip)).store(b + i);
+        }
+        return i;
+    }
+
+    template<bool Lower>
+    struct ascii_case_transform {
+        static constexpr std::uint_least32_t lo = Lower ? 0x41u : 0x61u;
+        static constexpr std::uint_least32_t hi = Lower ? 0x5Au : 0x7Au;
+
+        template<typename CharT>
+        [[nodiscard]] static std::size_t find(const CharT* p, std::size_t n) noexcept {
+            return find_first_code_unit(p, n, code_unit_range_pred{ lo, hi });
+        }
+
+        template<typename CharT>
+        static std::size_t apply(CharT* p, std::size_t n, std::size_t first) noexcept {
+            std::size_t i = first;
+            if constexpr (is_byte_char<CharT>) {
+#ifdef STRING_OR_VIEW_SIMD_AVX2
+                i = batched_case_change<CharT, avx2_batch>(p, n, i, lo, hi, Lower);
+#endif
+#ifdef STRING_OR_VIEW_SIMD_SSE2
+                i = batched_case_change<CharT, sse2_batch>(p, n, i, lo, hi, Lower);
+#endif
+            }
+            for (; i < n; ++i) {
+                std::uint_least32_t u = code_unit(p[i]);
+                if (lo <= u && u <= hi) p[i] = static_cast<CharT>(Lower ? (u | 0x20u) : (u & ~static_cast<std::uint_least32_t>(0x20u)));
+            }
+            return n;
+        }
+    };
+
+    // A run of whitespace that isn't a single ' '
+    struct collapse_whitespace_pred {
+        [[nodiscard]] std::size_t lookahead() const noexcept { return 1; }
+        [[nodiscard]] bool match_scalar(const unsigned char* p, const unsigned char* end) const noexcept {
+            return is_ascii_whitespace(*p) && (*p != 0x20u || (p + 1 != end && is_ascii_whitespace(p[1])));
+        }
+        template<typename Batch>
+        [[nodiscard]] Batch match(const unsigned char* p) const noexcept {
+            Batch current = Batch::load(p);
+            Batch next = Batch::load(p + 1);
+            Batch space = current.eq(0x20);
+            Batch ws = space | current.in_range(0x09, 0x0D);
+            Batch next_ws = next.eq(0x20) | next.in_range(0x09, 0x0D);
+            return and_not(ws, space) | (space & next_ws);
+        }
+    };
+
+    struct collapse_whitespace_transform {
+        template<typename CharT>
+        [[nodiscard]] static std::size_t find(const CharT* p, std::size_t n) noexcept {
+            if constexpr (is_byte_char<CharT>) {
+                return find_first(reinterpret_cast<const unsigned char*>(p), n, collapse_whitespace_pred{});
+            } else {
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (is_ascii_whitespace(p[i]) && (code_unit(p[i]) != 0x20u || (i + 1 != n && is_ascii_whitespace(p[i + 1])))) return i;
+                }
+                return n;
+            }
+        }
+
+        template<typename CharT>
+        static std::size_t apply(CharT* p, std::size_t n, std::size_t first) noexcept {
+            std::size_t out = first;
+            std::size_t i = first;
+            while (i < n) {
+                // p[i] is always whitespace at the top of the loop
+                p[out++] = static_cast<CharT>(0x20);
+                ++i;
+                while (i < n && is_ascii_whitespace(p[i])) ++i;
+                std::size_t run = find_first_code_unit(p + i, n - i, ascii_whitespace_pred{});
+                shift_down(p, out, i, run);
+                out += run;
+                i += run;
+            }
+            return out;
+        }
+    };
+
+    struct percent_decode_transform {
+        template<typename CharT>
+        [[nodiscard]] static bool is_escape(const CharT* p, std::size_t n, std::size_t i) noexcept {
+            return n - i >= 3 && hex_digit_value(p[i + 1]) >= 0 && hex_digit_value(p[i + 2]) >= 0;
+        }
+
+        template<typename CharT>
+        [[nodiscard]] static std::size_t find(const CharT* p, std::size_t n) noexcept {
+            std::size_t i = 0;
+            while (true) {
+                i += find_first_code_unit(p + i, n - i, code_unit_range_pred{ 0x25u, 0x25u });
+                if (i == n || is_escape(p, n, i)) return i;
+                ++i;
+            }
+        }
+
+        template<typename CharT>
+        static std::size_t apply(CharT* p, std::size_t n, std::size_t first) noexcept {
+            std::size_t out = first;
+            std::size_t i = first;
+            while (i < n) {
+                // p[i] is always '%' at the top of the loop
+                if (is_escape(p, n, i)) {
+                    p[out++] = static_cast<CharT>(hex_digit_value(p[i + 1]) * 16 + hex_digit_value(p[i + 2]));
+                    i += 3;
+                } else {
+                    p[out++] = p[i++];
+                }
+                std::size_t run = find_first_code_unit(p + i, n - i, code_unit_range_pred{ 0x25u, 0x25u });
+                shift_down(p, out, i, run);
+                out += run;
+                i += run;
+            }
+            return out;
+        }
+    };
+
+    struct json_unescape_transform {
+        // Value of the 4 hex digits after "\u" at p[i], or -1 if it isn't a valid \u escape
+        template<typename CharT>
+        [[nodiscard]] static long unicode_escape_value(const CharT* p, std::size_t n, std::size_t i) noexcept {
+            if (n - i < 6 || code_unit(p[i + 1]) != 0x75u) return -1;
+            long value = 0;
+            for (std::size_t j = i + 2; j != i + 6; ++j) {
+                int d = hex_digit_value(p[j]);
+                if (d < 0) return -1;
+                value = value * 16 + d;
+            }
+            return value;
+        }
+
+        // Replacement for a two character escape, or 0 if it is not one
+        template<typename CharT>
+        [[nodiscard]] static std::uint_least32_t simple_escape_value(CharT c) noexcept {
+            switch (code_unit(c)) {
+            case 0x22u: return 0x22u;  // \"
+            case 0x5Cu: return 0x5Cu;  // \\ (backslash)
+            case 0x2Fu: return 0x2Fu;  // \/
+            case 0x62u: return 0x08u;  // \b
+            case 0x66u: return 0x0Cu;  // \f
+            case 0x6Eu: return 0x0Au;  // \n
+            case 0x72u: return 0x0Du;  // \r
+            case 0x74u: return 0x09u;  // \t
+            default: return 0;
+            }
+        }
+
+        template<typename CharT>
+        [[nodiscard]] static bool is_escape(const CharT* p, std::size_t n, std::size_t i) noexcept {
+            return n - i >= 2 && (simple_escape_value(p[i + 1]) != 0 || unicode_escape_value(p, n, i) >= 0);
+        }
+
+        // Write the code point as UTF-8, UTF-16 or UTF-32 depending on sizeof(CharT). Returns the new output index
+        template<typename CharT>
+        static std::size_t encode(CharT* p, std::size_t out, std::uint_least32_t cp) noexcept {
+            if constexpr (sizeof(CharT) == 1) {
+                if (cp < 0x80u) {
+                    p[out++] = static_cast<CharT>(cp);
+                } else if (cp < 0x800u) {
+                    p[out++] = static_cast<CharT>(0xC0u | (cp >> 6));
+                    p[out++] = static_cast<CharT>(0x80u | (cp & 0x3Fu));
+                } else if (cp < 0x10000u) {
+                    p[out++] = static_cast<CharT>(0xE0u | (cp >> 12));
+                    p[out++] = static_cast<CharT>(0x80u | ((cp >> 6) & 0x3Fu));
+                    p[out++] = static_cast<CharT>(0x80u | (cp & 0x3Fu));
+                } else {
+                    p[out++] = static_cast<CharT>(0xF0u | (cp >> 18));
+                    p[out++] = static_cast<CharT>(0x80u | ((cp >> 12) & 0x3Fu));
+                    p[out++] = static_cast<CharT>(0x80u | ((cp >> 6) & 0x3Fu));
+                    p[out++] = static_cast<CharT>(0x80u | (cp & 0x3Fu));
+                }
+            } else if constexpr (sizeof(CharT) == 2) {
+                if (cp < 0x10000u) {
+                    p[out++] = static_cast<CharT>(cp);
+                } else {
+                    cp -= 0x10000u;
+                    p[out++] = static_cast<CharT>(0xD800u | (cp >> 10));
+                    p[out++] = static_cast<CharT>(0xDC00u | (cp & 0x3FFu));
+                }
+            } else {
+                p[out++] = static_cast<CharT>(cp);
+            }
+            return out;
+        }
+
+        template<typename CharT>
+        [[nodiscard]] static std::size_t find(const CharT* p, std::size_t n) noexcept {
+            std::size_t i = 0;
+            while (true) {
+                i += find_first_code_unit(p + i, n - i, code_unit_range_pred{ 0x5Cu, 0x5Cu });
+                if (i == n || is_escape(p, n, i)) return i;
+                ++i;
+            }
+        }
+
+        template<typename CharT>
+        static std::size_t apply(CharT* p, std::size_t n, std::size_t first) noexcept {
+            std::size_t out = first;
+            std::size_t i = first;
+            while (i < n) {
+                // p[i] is always a backslash at the top of the loop
+                std::uint_least32_t simple = n - i >= 2 ? simple_escape_value(p[i + 1]) : 0;
+                long unicode;
+                if (simple != 0) {
+                    p[out++] = static_cast<CharT>(simple);
+                    i += 2;
+                } else if ((unicode = unicode_escape_value(p, n, i)) >= 0) {
+                    std::uint_least32_t cp = static_cast<std::uint_least32_t>(unicode);
+                    i += 6;
+                    if (cp >= 0xD800u && cp <= 0xDBFFu) {
+                        long low = i < n && code_unit(p[i]) == 0x5Cu ? unicode_escape_value(p, n, i) : -1;
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000u + ((cp - 0xD800u) << 10) + (static_cast<std::uint_least32_t>(low) - 0xDC00u);
+                            i += 6;
+                        } else {
+                            cp = 0xFFFDu;
+                        }
+                    } else if (cp >= 0xDC00u && cp <= 0xDFFFu) {
+                        cp = 0xFFFDu;
+                    }
+                    out = encode(p, out, cp);
+                } else {
+                    p[out++] = p[i++];
+                }
+                std::size_t run = find_first_code_unit(p + i, n - i, code_unit_range_pred{ 0x5Cu, 0x5Cu });
+                shift_down(p, out, i, run);
+                out += run;
+                i += run;
+            }
+            return out;
+        }
+    };
+
+    template<typename Transform, typename CharT, typename Traits, typename Allocator>
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> transform_copy(const basic_string_or_view<CharT, Traits, Allocator>& s, const Allocator& alloc) {
+        std::basic_string_view<CharT, Traits> v = *s;
+        std::size_t first = Transform::find(v.data(), v.size());
+        if (first == v.size()) {
+            // Copying a view keeps whether it is null terminated
+            if (s.is_viewing()) return s;
+            return v;
+        }
+        std::basic_string<CharT, Traits, Allocator> result(v, s.get_allocator_or(alloc));
+        result.resize(Transform::apply(&result[0], result.size(), first));
+        return static_cast<std::basic_string<CharT, Traits, Allocator>&&>(result);
+    }
+
+    template<typename Transform, typename CharT, typename Traits, typename Allocator>
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> transform_in_place(basic_string_or_view<CharT, Traits, Allocator>&& s, const Allocator& alloc) {
+        if (s.is_viewing()) return transform_copy<Transform>(s, alloc);
+        std::basic_string<CharT, Traits, Allocator>& owned = s.access_underlying_owned();
+        std::size_t first = Transform::find(owned.data(), owned.size());
+        if (first != owned.size()) owned.resize(Transform::apply(&owned[0], owned.size(), first));
+        return static_cast<basic_string_or_view<CharT, Traits, Allocator>&&>(s);
+    }
+
+    template<bool Left, bool Right, typename CharT, typename Traits, typename Allocator>
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> trim(basic_string_or_view<CharT, Traits, Allocator>&& s) noexcept {
+        std::basic_string_view<CharT, Traits> v = *s;
+        std::size_t end = v.size();
+        if constexpr (Right) {
+            while (end != 0 && is_ascii_whitespace(v[end - 1])) --end;
+        }
+        std::size_t begin = 0;
+        if constexpr (Left) {
+            begin = find_first_code_unit(v.data(), end, not_pred<ascii_whitespace_pred>{});
+        }
+        // Neither of these allocate
+        s.remove_suffix(v.size() - end);
+        s.remove_prefix(begin);
+        return static_cast<basic_string_or_view<CharT, Traits, Allocator>&&>(s);
+    }
+
+    template<typename CharT>
+    inline constexpr bool is_code_unit = std::is_same<CharT, char>::value || std::is_same<CharT, wchar_t>::value ||
+#ifdef __cpp_char8_t
+        std::is_same<CharT, char8_t>::value ||
+#endif
+        std::is_same<CharT, char16_t>::value || std::is_same<CharT, char32_t>::value;
+
+    // The std::basic_string_view that overload (3) of a transform views its argument as: string views as they are, and null terminated
+    // pointers to (and so arrays of, like string literals) code units. No `type` for anything else
+    template<typename T, typename = void>
+    struct transform_view {};
+
+    template<typename CharT, typename Traits>
+    struct transform_view<std::basic_string_view<CharT, Traits>> {
+        using type = std::basic_string_view<CharT, Traits>;
+    };
+
+    template<typename CharT>
+    struct transform_view<CharT*, std::enable_if_t<is_code_unit<std::remove_const_t<CharT>>>> {
+        using type = std::basic_string_view<std::remove_const_t<CharT>>;
+    };
+
+    template<typename T>
+    using transform_view_t = typename transform_view<std::decay_t<T>>::type;
+
+    template<typename T>
+    using transform_result_t = basic_string_or_view<typename transform_view_t<T>::value_type, typename transform_view_t<T>::traits_type>;
+
+    // A viewing basic_string_or_view of an argument of overload (3). A pointer is null terminated
+    template<typename T>
+    [[nodiscard]] transform_result_t<T> transform_argument(const T& s) noexcept {
+        if constexpr (std::is_pointer<std::decay_t<T>>::value) {
+            return transform_result_t<T>(static_cast<const typename transform_view_t<T>::value_type*>(s));
+        } else {
+            return transform_result_t<T>(s);
+        }
+    }
+
+}  // namespace string_or_view_detail
+
+// For each transform `f`:
+//
+//     basic_string_or_view f(const basic_string_or_view& s, const allocator_type& alloc = allocator_type());  // (1)
+//     basic_string_or_view f(basic_string_or_view&& s, const allocator_type& alloc = allocator_type());  // (2)
+//     basic_string_or_view<CharT, Traits> f(const T& s);  // (3)
+//     basic_string_or_view<CharT, Traits, Allocator> f(const std::basic_string<CharT, Traits, Allocator>& s);  // (4)
+//     basic_string_or_view<CharT, Traits, Allocator> f(std::basic_string<CharT, Traits, Allocator>&& s);  // (5)
+//
+// (1) If unchanged, returns a view of `s` (even if `s` is owning, so the result may not outlive `s`).
+//     Otherwise returns an owning transformed copy, allocated with `s.get_allocator_or(alloc)`
+// (2) If `s` is owning, transforms the held string in place and returns it. Otherwise same as (1).
+// (3) For a std::basic_string_view<CharT, Traits> or a null terminated `const CharT*` (including a string literal):
+//     the same as (1) with a view of `s`. Not deduced from the parameter type, so `f("ABC")` works
+// (4) The same as (1) with a view of `s`, allocating with `s.get_allocator()`
+// (5) The same as (2) with `s` moved into an owning basic_string_or_view, so the result never views a temporary
+#define STRING_OR_VIEW_DEFINE_TRANSFORM(name, ...) \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(const basic_string_or_view<CharT, Traits, Allocator>& s, const Allocator& alloc = Allocator()) { \
+        return ::string_or_view_detail::transform_copy<__VA_ARGS__>(s, alloc); \
+    } \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(basic_string_or_view<CharT, Traits, Allocator>&& s, const Allocator& alloc = Allocator()) { \
+        return ::string_or_view_detail::transform_in_place<__VA_ARGS__>(static_cast<basic_string_or_view<CharT, Traits, Allocator>&&>(s), alloc); \
+    } \
+    template<typename T> \
+    [[nodiscard]] ::string_or_view_detail::transform_result_t<T> name(const T& s) { \
+        return ::string_or_view_detail::transform_copy<__VA_ARGS__>(::string_or_view_detail::transform_argument(s), std::allocator<typename ::string_or_view_detail::transform_view_t<T>::value_type>()); \
+    } \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(const std::basic_string<CharT, Traits, Allocator>& s) { \
+        return ::string_or_view_detail::transform_copy<__VA_ARGS__>(basic_string_or_view<CharT, Traits, Allocator>(std::basic_string_view<CharT, Traits>(s)), s.get_allocator()); \
+    } \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(std::basic_string<CharT, Traits, Allocator>&& s) { \
+        Allocator alloc = s.get_allocator(); \
+        return ::string_or_view_detail::transform_in_place<__VA_ARGS__>(basic_string_or_view<CharT, Traits, Allocator>(static_cast<std::basic_string<CharT, Traits, Allocator>&&>(s)), alloc); \
+    }
+
+// 'A'-'Z' to 'a'-'z'. Other code units are unchanged
+STRING_OR_VIEW_DEFINE_TRANSFORM(ascii_tolower, ::string_or_view_detail::ascii_case_transform<true>)
+// 'a'-'z' to 'A'-'Z'. Other code units are unchanged
+STRING_OR_VIEW_DEFINE_TRANSFORM(ascii_toupper, ::string_or_view_detail::ascii_case_transform<false>)
+// Replace every run of ASCII whitespace (" \t\n\v\f\r") with a single ' '. Does not trim
+STRING_OR_VIEW_DEFINE_TRANSFORM(collapse_ascii_whitespace, ::string_or_view_detail::collapse_whitespace_transform)
+// Replace "%XX" (two hex digits) with the code unit 0xXX. Malformed escapes and '+' are left as is
+STRING_OR_VIEW_DEFINE_TRANSFORM(percent_decode, ::string_or_view_detail::percent_decode_transform)
+// Decode the escapes in the body of a JSON string (without the surrounding quotes). "\uXXXX" escapes are encoded
+// as UTF-8, UTF-16 or UTF-32 depending on the size of the code unit, and unpaired surrogates become U+FFFD.
+// Malformed escapes are left as is
+STRING_OR_VIEW_DEFINE_TRANSFORM(json_unescape, ::string_or_view_detail::json_unescape_transform)
+
+#undef STRING_OR_VIEW_DEFINE_TRANSFORM
+
+// Remove leading and/or trailing ASCII whitespace. Never allocates: always a view of (or the moved) input,
+// with the same overloads as the other transforms
+#define STRING_OR_VIEW_DEFINE_TRIM(name, left, right) \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(const basic_string_or_view<CharT, Traits, Allocator>& s) noexcept { \
+        /* Copying a view keeps whether it is null terminated */ \
+        return ::string_or_view_detail::trim<left, right>(s.is_viewing() ? basic_string_or_view<CharT, Traits, Allocator>(s) : basic_string_or_view<CharT, Traits, Allocator>(*s)); \
+    } \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(basic_string_or_view<CharT, Traits, Allocator>&& s) noexcept { \
+        return ::string_or_view_detail::trim<left, right>(static_cast<basic_string_or_view<CharT, Traits, Allocator>&&>(s)); \
+    } \
+    template<typename T> \
+    [[nodiscard]] ::string_or_view_detail::transform_result_t<T> name(const T& s) noexcept { \
+        return ::string_or_view_detail::trim<left, right>(::string_or_view_detail::transform_argument(s)); \
+    } \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(const std::basic_string<CharT, Traits, Allocator>& s) noexcept { \
+        return ::string_or_view_detail::trim<left, right>(basic_string_or_view<CharT, Traits, Allocator>(std::basic_string_view<CharT, Traits>(s))); \
+    } \
+    template<typename CharT, typename Traits, typename Allocator> \
+    [[nodiscard]] basic_string_or_view<CharT, Traits, Allocator> name(std::basic_string<CharT, Traits, Allocator>&& s) noexcept { \
+        return ::string_or_view_detail::trim<left, right>(basic_string_or_view<CharT, Traits, Allocator>(static_cast<std::basic_string<CharT, Traits, Allocator>&&>(s))); \
+    }
+
+STRING_OR_VIEW_DEFINE_TRIM(ascii_trim, true, true)
+STRING_OR_VIEW_DEFINE_TRIM(ascii_trim_left, true, false)
+STRING_OR_VIEW_DEFINE_TRIM(ascii_trim_right, false, true)
+
+#undef STRING_OR_VIEW_DEFINE_TRIM
+
+#endif  // STRING_OR_VIEW_TRANSFORM_H